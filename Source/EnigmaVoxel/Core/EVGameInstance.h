@@ -4,11 +4,12 @@
 
 #include "CoreMinimal.h"
 #include "Engine/GameInstance.h"
+#include "EnigmaVoxel/Modules/Chunk/ChunkLayout.h"
 #include "EVGameInstance.generated.h"
 
-constexpr int32 ChunkBlockXCount = 16;
-constexpr int32 ChunkBlockYCount = 16;
-constexpr int32 ChunkBlockZCount = 16;
+constexpr int32 ChunkBlockXCount = FChunkLayout::SizeX;
+constexpr int32 ChunkBlockYCount = FChunkLayout::SizeY;
+constexpr int32 ChunkBlockZCount = FChunkLayout::SizeZ;
 constexpr float BlockWorldSize   = 100.f;
 constexpr float ChunkWorldSize   = BlockWorldSize * ChunkBlockXCount;
 
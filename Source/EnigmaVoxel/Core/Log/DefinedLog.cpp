@@ -7,3 +7,4 @@ DEFINE_LOG_CATEGORY(LogEnigmaVoxelChunk);
 DEFINE_LOG_CATEGORY(LogEnigmaVoxelWorld);
 DEFINE_LOG_CATEGORY(LogEnigmaVoxelBlock)
 DEFINE_LOG_CATEGORY(LogEnigmaVoxelWorker)
+DEFINE_LOG_CATEGORY(LogEnigmaVoxelNet)
@@ -12,3 +12,5 @@ DECLARE_LOG_CATEGORY_EXTERN(LogEnigmaVoxelWorld, Log, All);
 DECLARE_LOG_CATEGORY_EXTERN(LogEnigmaVoxelBlock, Log, All);
 
 DECLARE_LOG_CATEGORY_EXTERN(LogEnigmaVoxelWorker, Log, All);
+
+DECLARE_LOG_CATEGORY_EXTERN(LogEnigmaVoxelNet, Log, All);
@@ -22,10 +22,29 @@ void UEnigmaRegistrationSubsystem::Initialize(FSubsystemCollectionBase& Collecti
 {
 	registrationSubsystem = this;
 	FRegistrationDelegates::OnRegistrationInitialize.Broadcast();
+	BLOCK_FREEZE();
 	UE_LOG(LogEnigmaVoxelRegister, Log, TEXT("EnigmaRegistrationSubsystem::Initialize"));
 	Super::Initialize(Collection);
 }
 
+void UEnigmaRegistrationSubsystem::Deinitialize()
+{
+	for (UBlockDefinition* Definition : BlockIDTable)
+	{
+		if (Definition && Definition->IsRooted())
+		{
+			Definition->RemoveFromRoot();
+		}
+	}
+	BlockIDTable        = {nullptr};
+	bBlockIDTableFrozen = false;
+	if (registrationSubsystem == this)
+	{
+		registrationSubsystem = nullptr;
+	}
+	Super::Deinitialize();
+}
+
 void UEnigmaRegistrationSubsystem::PostInitProperties()
 {
 	Super::PostInitProperties();
@@ -54,3 +73,59 @@ UBlockDefinition* UEnigmaRegistrationSubsystem::BLOCK_GET_VALUE(FString NameSpac
 	UBlockRegister* blockRegister = BLOCK(NameSpace);
 	return Cast<UBlockDefinition>(blockRegister->GetDefinitionByID(ID));
 }
+
+UBlockDefinition* UEnigmaRegistrationSubsystem::BLOCK_GET_BY_ID(int64 BlockID)
+{
+	if (!registrationSubsystem || !registrationSubsystem->BlockIDTable.IsValidIndex(BlockID))
+	{
+		return nullptr;
+	}
+	return registrationSubsystem->BlockIDTable[BlockID];
+}
+
+int64 UEnigmaRegistrationSubsystem::BLOCK_GET_MAX_ID()
+{
+	return registrationSubsystem ? registrationSubsystem->BlockIDTable.Num() - 1 : 0;
+}
+
+int64 UEnigmaRegistrationSubsystem::BLOCK_ASSIGN_ID(UBlockDefinition* Definition)
+{
+	if (!registrationSubsystem || !Definition)
+	{
+		return 0;
+	}
+	if (registrationSubsystem->bBlockIDTableFrozen)
+	{
+		UE_LOG(LogEnigmaVoxelRegister, Error, TEXT("Block registration is frozen, %s has no block ID"), *Definition->ID);
+		return 0;
+	}
+	if (registrationSubsystem->BlockIDTable.Num() > MAX_uint16)
+	{
+		UE_LOG(LogEnigmaVoxelRegister, Error, TEXT("Too many blocks, %s has no block ID"), *Definition->ID);
+		return 0;
+	}
+	Definition->BlockID = registrationSubsystem->BlockIDTable.Add(Definition);
+	return Definition->BlockID;
+}
+
+void UEnigmaRegistrationSubsystem::BLOCK_FREEZE()
+{
+	if (!registrationSubsystem || registrationSubsystem->bBlockIDTableFrozen)
+	{
+		return;
+	}
+	for (UBlockDefinition* Definition : registrationSubsystem->BlockIDTable)
+	{
+		if (Definition)
+		{
+			Definition->AddToRoot();
+		}
+	}
+	registrationSubsystem->bBlockIDTableFrozen = true;
+	UE_LOG(LogEnigmaVoxelRegister, Log, TEXT("Block registration frozen with %d blocks"), registrationSubsystem->BlockIDTable.Num() - 1);
+}
+
+bool UEnigmaRegistrationSubsystem::BLOCK_IS_FROZEN()
+{
+	return registrationSubsystem && registrationSubsystem->bBlockIDTableFrozen;
+}
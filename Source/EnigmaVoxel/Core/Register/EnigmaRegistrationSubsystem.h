@@ -43,6 +43,7 @@ public:
 	TMap<FString, FResourceRegister> RegisterMap;
 
 	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
 	virtual void PostInitProperties() override;
 
 	UFUNCTION(BlueprintCallable, Category = "Registration")
@@ -51,8 +52,26 @@ public:
 	/// Query
 	UFUNCTION(BlueprintCallable, Category = "Registration")
 	static UBlockDefinition* BLOCK_GET_VALUE(FString NameSpace = "Enigma", FString ID = "");
+	/// Resolve a global block ID (UBlockDefinition::BlockID), 0 is air and return nullptr
+	UFUNCTION(BlueprintCallable, Category = "Registration")
+	static UBlockDefinition* BLOCK_GET_BY_ID(int64 BlockID);
+	/// Highest global block ID registered so far, 0 with air only
+	static int64 BLOCK_GET_MAX_ID();
+
+	/// Give the definition the next global block ID, called by the block registers on registration
+	static int64 BLOCK_ASSIGN_ID(UBlockDefinition* Definition);
+	/// Close block registration once every mod registered its content. The ID table never changes
+	/// afterward (lock free reads from the chunk workers) and its definitions are rooted, chunk data
+	/// only stores IDs so the GC does not have to reach the definitions through loaded voxels
+	static void BLOCK_FREEZE();
+	static bool BLOCK_IS_FROZEN();
 
 private:
+	/// Global block ID -> definition across every namespace, index 0 is reserved for air.
+	/// Not a UPROPERTY, the definitions are rooted when the table is frozen
+	TArray<UBlockDefinition*> BlockIDTable = {nullptr};
+	bool                      bBlockIDTableFrozen = false;
+
 	static UEnigmaRegistrationSubsystem* registrationSubsystem;
 	static URegistrationDelegates*       EventDispatcher;
 };
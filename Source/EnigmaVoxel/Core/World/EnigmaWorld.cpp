@@ -4,16 +4,58 @@
 #include "EnigmaWorld.h"
 #include "EnigmaVoxel/Core/EVGameInstance.h"
 #include "EnigmaVoxel/Core/Log/DefinedLog.h"
+#include "EnigmaVoxel/Modules/Block/Enum/BlockDirection.h"
 #include "EnigmaVoxel/Modules/Chunk/ChunkHolder.h"
+#include "EnigmaVoxel/Modules/Chunk/ChunkLight.h"
+#include "EnigmaVoxel/Modules/Chunk/ChunkRegion.h"
+#include "EnigmaVoxel/Modules/Chunk/RegionActor.h"
+#include "EnigmaVoxel/Modules/Horizon/HorizonActor.h"
+#include "EnigmaVoxel/Modules/Horizon/HorizonTile.h"
+#include "EnigmaVoxel/Modules/Net/ChunkStreamComponent.h"
+#include "Gen/WorldGen.hpp"
+#include "VoxelCoords.h"
 #include "Thread/ChunkWorkerPool.h"
+#include "Async/ParallelFor.h"
+#include "HAL/IConsoleManager.h"
+#include "UObject/UObjectIterator.h"
+
+namespace
+{
+	/// Floor division, chunk coordinates are negative on half of the world
+	int32 FloorDiv(int32 A, int32 B)
+	{
+		return A >= 0 ? A / B : -((-A + B - 1) / B);
+	}
+
+	/// Box queries are Blueprint callable, a box past this many voxels (64 MB of block IDs) is refused
+	constexpr int64 MaxBoxQueryVoxels = 1 << 24;
+
+	/// Voxel count of the inclusive box, computed in 64 bits. 0 if it exceeds MaxBoxQueryVoxels
+	int32 GetBoxVoxelCount(const FIntVector& MinPos, const FIntVector& MaxPos)
+	{
+		const int64 SizeX = static_cast<int64>(MaxPos.X) - MinPos.X + 1;
+		const int64 SizeY = static_cast<int64>(MaxPos.Y) - MinPos.Y + 1;
+		const int64 SizeZ = static_cast<int64>(MaxPos.Z) - MinPos.Z + 1;
+		if (SizeX > MaxBoxQueryVoxels || SizeY > MaxBoxQueryVoxels || SizeZ > MaxBoxQueryVoxels
+			|| SizeX * SizeY > MaxBoxQueryVoxels || SizeX * SizeY * SizeZ > MaxBoxQueryVoxels)
+		{
+			UE_LOG(LogEnigmaVoxelWorld, Warning, TEXT("Box query %s -> %s is over %lld voxels, ignored"), *MinPos.ToString(), *MaxPos.ToString(), MaxBoxQueryVoxels);
+			return 0;
+		}
+		return static_cast<int32>(SizeX * SizeY * SizeZ);
+	}
+}
 
 UWorld* UEnigmaWorld::GetWorld() const
 {
 	return CurrentUWorld;
 }
 
-void UEnigmaWorld::GatherPlayerVisibleSet(TSet<FIntVector>& Out)
+/// Ticket levels of this tick: players render their view square, registered entities and
+/// forced chunks only keep their area simulated. Every source is surrounded by data-only rings
+void UEnigmaWorld::GatherTicketLevels(TMap<FIntVector, EChunkTicketLevel>& Out)
 {
+	PlayerChunkCenters.Reset();
 	for (FConstPlayerControllerIterator It = CurrentUWorld->GetPlayerControllerIterator(); It; ++It)
 	{
 		if (const APlayerController* PC = It->Get())
@@ -24,145 +66,1029 @@ void UEnigmaWorld::GatherPlayerVisibleSet(TSet<FIntVector>& Out)
 				continue;
 			}
 
-			FIntVector Center = WorldPosToChunkCoords(P->GetActorLocation());
-			for (int dy = -ViewRadius; dy <= ViewRadius; ++dy)
+			FIntVector Center = WorldPosToChunkCoords(ToAbsoluteWorldPos(P->GetActorLocation()));
+			PlayerChunkCenters.AddUnique(Center);
+			AddTicketSource(Center, ETicketType::Player, Out);
+		}
+	}
+
+	for (const APawn* P : Players)
+	{
+		// Controlled pawns already hold a player ticket
+		if (IsValid(P) && !P->IsPlayerControlled())
+		{
+			AddTicketSource(WorldPosToChunkCoords(ToAbsoluteWorldPos(P->GetActorLocation())), ETicketType::Entity, Out);
+		}
+	}
+
+	for (const FIntVector& Forced : ForcedChunks)
+	{
+		AddTicketSource(Forced, ETicketType::Forced, Out);
+	}
+}
+
+void UEnigmaWorld::AddTicketSource(const FIntVector& Center, ETicketType Type, TMap<FIntVector, EChunkTicketLevel>& Out) const
+{
+	// Outer Chebyshev radius of every level ring, INDEX_NONE when the source does not give the level
+	int32 RenderRadius   = INDEX_NONE;
+	int32 SimulateRadius = FMath::Max(0, Type == ETicketType::Entity ? EntityTicketRadius : ForcedTicketRadius);
+	if (Type == ETicketType::Player)
+	{
+		// Nothing is drawn in a data-only world, the view square is only simulated
+		RenderRadius   = bDataOnlyMode ? INDEX_NONE : FMath::Max(0, ViewRadius);
+		SimulateRadius = FMath::Max(0, ViewRadius) + FMath::Max(0, SimulationRingChunks);
+	}
+	const int32 DataRadius = SimulateRadius + FMath::Max(0, DataRingChunks);
+
+	for (int32 dy = -DataRadius; dy <= DataRadius; ++dy)
+	{
+		for (int32 dx = -DataRadius; dx <= DataRadius; ++dx)
+		{
+			const int32       Distance = FMath::Max(FMath::Abs(dx), FMath::Abs(dy));
+			EChunkTicketLevel Level    = EChunkTicketLevel::DataOnly;
+			if (Distance <= RenderRadius)
 			{
-				for (int dx = -ViewRadius; dx <= ViewRadius; ++dx)
-				{
-					Out.Add(Center + FIntVector(dx, dy, 0));
-				}
+				Level = EChunkTicketLevel::Render;
 			}
+			else if (Distance <= SimulateRadius)
+			{
+				Level = EChunkTicketLevel::Simulate;
+			}
+
+			EChunkTicketLevel& Current = Out.FindOrAdd(Center + FIntVector(dx, dy, 0), EChunkTicketLevel::None);
+			Current                    = FMath::Min(Current, Level);
 		}
 	}
 }
 
 void UEnigmaWorld::FlushDirtyAndPending(double Now)
 {
-	FScopeLock _(&ChunksMutex);
+	FWriteScopeLock _(ChunksLock);
 
-	for (auto It = Chunks.CreateIterator(); It; ++It)
+	ResidentBytes = 0;
+	for (auto& KV : Chunks)
 	{
-		FChunkHolder* H = It.Value().Get();
+		FChunkHolder* H = KV.Value;
+
+		// Simulated and data-only chunks are not drawn, free their mesh once no worker writes it.
+		// A data-only world keeps the dirty flag, the rebuild refreshes the collision boxes
+		const bool bBuilding = H->BuildFuture.IsValid() && !H->BuildFuture->IsReady();
+		if (H->HasTicket() && !H->IsRendered() && !bBuilding)
+		{
+			if (!bDataOnlyMode)
+			{
+				H->bDirty = false;
+			}
+			if (H->bHasMesh)
+			{
+				H->DropMesh();
+			}
+		}
 
-		if (H->bDirty && !H->bQueuedForRebuild.exchange(true))
+		// The mesher reads the light nibbles a running light stage writes, the stage marks the chunk dirty again when it ends
+		// A build in flight keeps the dirty flag, the rebuild is queued once it is done
+		if (H->bDirty && H->LightStageCount == 0 && !bBuilding && !H->bQueuedForRebuild.exchange(true))
 		{
 			H->bDirty = false;
 			ChunkWorkerPool->EnqueueBuildTask(H, /*bMeshOnly=*/true, this);
 		}
 
-		// Exceed Grace period, destroy.
+		// Exceed Grace period, release the render actor but keep the data warm until evicted.
 		if (H->Stage == EChunkStage::PendingUnload && H->PendingUnloadUntil < Now)
 		{
-			if (AChunkActor* CA = LoadedChunks.FindRef(H->Coords))
+			ReleaseChunkRender(*H);
+		}
+
+		ResidentBytes += H->GetAllocatedSize();
+	}
+
+	EvictOverBudget();
+}
+
+/// Evict unticketed chunks, least recently used first, until the resident
+/// chunk memory goes back under ResidentMemoryBudgetMB. Ticketed chunks are
+/// never evicted, so the budget is a soft ceiling when every chunk is in view.
+void UEnigmaWorld::EvictOverBudget()
+{
+	WarmCache.SetBudget(static_cast<SIZE_T>(FMath::Max(0, WarmCacheBudgetMB)) * 1024 * 1024);
+
+	const SIZE_T Budget = static_cast<SIZE_T>(FMath::Max(0, ResidentMemoryBudgetMB)) * 1024 * 1024;
+	if (ResidentBytes <= Budget)
+	{
+		return;
+	}
+
+	TArray<FChunkHolder*> Candidates;
+	for (auto& KV : Chunks)
+	{
+		FChunkHolder* H = KV.Value;
+		if (H->Stage != EChunkStage::PendingUnload || H->HasTicket())
+		{
+			continue;
+		}
+		// A worker still writes into the holder, wait for the job to finish before recycling
+		if (H->BuildFuture.IsValid() && !H->BuildFuture->IsReady())
+		{
+			continue;
+		}
+		// Same for a light stage, it reads and writes the neighbours of its chunk too
+		if (H->LightStageCount > 0)
+		{
+			continue;
+		}
+		Candidates.Add(H);
+	}
+	Candidates.Sort([](const FChunkHolder& A, const FChunkHolder& B)
+	{
+		return A.LastTouchedTime < B.LastTouchedTime;
+	});
+
+	for (FChunkHolder* H : Candidates)
+	{
+		if (ResidentBytes <= Budget)
+		{
+			break;
+		}
+		ReleaseChunkRender(*H);
+		// A client copy may be stale by the time it comes back, the server sends it again instead
+		if (IsNetClient())
+		{
+			DroppedChunks.AddUnique(H->Coords);
+		}
+		else if (H->bDataReady)
+		{
+			WarmCache.Store(*H, H->LastTouchedTime);
+		}
+		ResidentBytes -= FMath::Min(ResidentBytes, H->GetAllocatedSize());
+		Chunks.Remove(H->Coords);
+		ChunkHolderPool.Release(H);
+	}
+}
+
+void UEnigmaWorld::Tick()
+{
+	if (!CurrentUWorld)
+	{
+		return;
+	}
+	const double Now = FPlatformTime::Seconds();
+
+	// Keep the rendered area near the engine origin before gathering positions
+	if (!bDataOnlyMode)
+	{
+		RebaseOriginIfNeeded();
+	}
+
+	// Collect the ticket level of every chunk for this tick
+	TMap<FIntVector, EChunkTicketLevel> Desired;
+	GatherTicketLevels(Desired);
+
+	// Apply the level changes -> submit task/unload
+	ProcessTickets(Desired, Now);
+
+	// Pick the mesh detail of every rendered chunk, a change only rebuilds the mesh
+	UpdateChunkLods();
+
+	// Thread pool result → Generate or update Actor
+	PumpWorkerResults();
+
+	// Simulate the blocks, then apply the edits and the received chunk packets of the idle chunks and light the next phase of chunks
+	TickBlocks();
+	ApplyBlockEdits();
+	ApplyChunkPackets();
+	ScheduleLightStages();
+
+	// Send the chunks and block changes to the remote clients, or report the dropped chunks to the server
+	UpdateChunkStreams(Now);
+
+	// Render stages, a data-only world has no chunk actor, region nor horizon
+	if (!bDataOnlyMode)
+	{
+		// Merge the region clusters whose members changed
+		UpdateRegions();
+
+		// Hide the chunk actors sealed from the camera
+		UpdateChunkVisibility();
+
+		// Stream the far horizon tiles around the players
+		UpdateHorizon();
+	}
+
+	// Handle bDirty reconstruction, release expired PendingUnload actors & evict over the memory budget
+	FlushDirtyAndPending(Now);
+
+	// Save the levels for next tick difference
+	PrevTicketLevels = MoveTemp(Desired);
+}
+
+void UEnigmaWorld::ProcessTickets(const TMap<FIntVector, EChunkTicketLevel>& Desired, double Now)
+{
+	FWriteScopeLock _(ChunksLock);
+
+	// Set the changed levels & possibly schedule tasks
+	for (const TPair<FIntVector, EChunkTicketLevel>& KV : Desired)
+	{
+		const FIntVector         C        = KV.Key;
+		const EChunkTicketLevel* Previous = PrevTicketLevels.Find(C);
+		if (Previous && *Previous == KV.Value)
+		{
+			continue;
+		}
+
+		FChunkHolder* H = Chunks.FindRef(C);
+		if (!H)
+		{
+			H = Chunks.Add(C, ChunkHolderPool.Acquire());
+			// Recently evicted, the worker decompress it instead of running the generator
+			H->WarmData             = WarmCache.Take(C);
+			H->TextureArrayMaterial = TextureArrayMaterial;
+		}
+
+		H->Coords = C;
+		H->SetTicketLevel(KV.Value, Now, GracePeriod);
+
+		// Left the rendered area, or came back below Render before the grace period ended
+		if (!H->IsRendered())
+		{
+			ReleaseChunkRender(*H);
+			EChunkStage Loaded = EChunkStage::Loaded;
+			H->Stage.compare_exchange_strong(Loaded, EChunkStage::Ready);
+		}
+
+		// A client waits for the packet of the server (ApplyChunkPackets). A holder brought back
+		// while its first generator still runs publishes Ready once it is done
+		if (H->Stage == EChunkStage::Loading)
+		{
+			H->LodLevel = GetLodLevelForDistance(GetChunkDistanceToPlayers(C));
+			if (!IsNetClient() && !(H->BuildFuture.IsValid() && !H->BuildFuture->IsReady()))
 			{
-				CA->Destroy();
-				LoadedChunks.Remove(H->Coords);
+				ChunkWorkerPool->EnqueueBuildTask(H, false, this);
 			}
-			It.RemoveCurrent();
 		}
 	}
+
+	// Drop the ticket of the chunks no source reaches anymore
+	for (const TPair<FIntVector, EChunkTicketLevel>& KV : PrevTicketLevels)
+	{
+		if (Desired.Contains(KV.Key))
+		{
+			continue;
+		}
+		if (FChunkHolder* H = Chunks.FindRef(KV.Key))
+		{
+			H->SetTicketLevel(EChunkTicketLevel::None, Now, GracePeriod);
+		}
+	}
+}
+
+
+void UEnigmaWorld::PumpWorkerResults()
+{
+	TArray<FChunkHolder*> ReadyHolders;
+	{
+		FReadScopeLock _(ChunksLock);
+		for (auto& KV : Chunks)
+		{
+			FChunkHolder* H = KV.Value;
+			// Ready is also set outside the worker (ticket changes), a rebuild may be writing the mesh meanwhile
+			const bool bBuilding = H->BuildFuture.IsValid() && !H->BuildFuture->IsReady();
+			if (H->Stage != EChunkStage::Ready || bBuilding)
+			{
+				continue;
+			}
+			// Not rendered, or rendered since a data-only build and not meshed yet: nothing to upload.
+			// The rendered neighbours already cull their border against its blocks, the collision
+			// boxes of a data-only world only depend on the chunk itself
+			if (!H->IsRendered() || !H->bHasMesh)
+			{
+				if (H->bNeedsNeighborNotify.exchange(false, std::memory_order_relaxed) && !bDataOnlyMode)
+				{
+					NotifyNeighborsChunkLoaded(H->Coords);
+				}
+				if (H->IsRendered() && !H->bDirty)
+				{
+					H->bDirty            = true;
+					H->bQueuedForRebuild = false;
+				}
+				continue;
+			}
+			ReadyHolders.Add(H);
+			if (MaxChunkUploadsPerTick > 0 && ReadyHolders.Num() >= MaxChunkUploadsPerTick)
+			{
+				break; // Frame budget reached, the rest stay Ready for the next tick
+			}
+		}
+	}
+
+	// Holders are only recycled by FlushDirtyAndPending on the game thread, safe to use them outside the lock
+	for (FChunkHolder* H : ReadyHolders)
+	{
+		UploadChunkToActor(*H);
+	}
+}
+
+/// Copy the worker results (render mesh, materials and collision boxes) into
+/// the chunk actor, acquire one from the pool if the chunk has none yet. A distant
+/// chunk goes to its region cluster instead, the merge picks it up next tick
+/// @param H A chunk in Ready stage
+void UEnigmaWorld::UploadChunkToActor(FChunkHolder& H)
+{
+	const FIntVector Coords = H.Coords;
+	if (H.bInRegion)
+	{
+		// Distant chunk, hand the mesh to its region cluster and give the actor back
+		if (AChunkActor* CA = LoadedChunks.FindRef(Coords))
+		{
+			ReleaseChunkActor(CA);
+			LoadedChunks.Remove(Coords);
+		}
+		const FIntVector          Region = GetRegionCoords(Coords);
+		TSharedPtr<FRegionMember> Member = MakeShared<FRegionMember>();
+		Member->Offset                   = FVector(Coords - Region * RegionClusterChunks) * ChunkWorldSize;
+		Member->Mesh                     = CopyTemp(H.Mesh);
+		Member->MaterialToSection        = H.MaterialToSection;
+		RegionMembers.Add(Coords, Member);
+		DirtyRegions.Add(Region);
+	}
+	else
+	{
+		AChunkActor* CA = LoadedChunks.FindRef(Coords);
+		if (!CA)
+		{
+			CA = AcquireChunkActor(Coords);
+			if (!CA)
+			{
+				return;
+			}
+			LoadedChunks.Add(Coords, CA);
+		}
+
+		UDynamicMesh* DynMesh = CA->GetDynamicMeshComponent()->GetDynamicMesh();
+		DynMesh->GetMeshRef() = CopyTemp(H.Mesh);
+		CA->UpdateChunkMaterial(H);
+		CA->UpdateChunkCollision(H.CollisionBoxes);
+	}
+
+	H.Stage = EChunkStage::Loaded;
+	// The LOD level changed while the worker was meshing, mesh again at the wanted level
+	if (H.MeshLodLevel != H.LodLevel)
+	{
+		H.bDirty            = true;
+		H.bQueuedForRebuild = false;
+	}
+	if (H.bNeedsNeighborNotify.exchange(false, std::memory_order_relaxed))
+	{
+		FReadScopeLock _(ChunksLock);
+		NotifyNeighborsChunkLoaded(Coords);
+	}
+}
+
+/// Walk the chunk occlusion graph from the camera chunk and hide the loaded
+/// chunk actors the walk cannot reach
+void UEnigmaWorld::UpdateChunkVisibility()
+{
+	const APlayerController* PC = CurrentUWorld->GetFirstPlayerController();
+	if (!PC || !PC->PlayerCameraManager)
+	{
+		return;
+	}
+
+	TSet<FIntVector> Visible;
+	if (bEnableOcclusionCulling)
+	{
+		TSet<FIntVector> Candidates;
+		LoadedChunks.GetKeys(Candidates);
+		const FIntVector CameraChunk = WorldPosToChunkCoords(ToAbsoluteWorldPos(PC->PlayerCameraManager->GetCameraLocation()));
+
+		FReadScopeLock _(ChunksLock);
+		FChunkVisibility::GatherVisibleChunks(CameraChunk, Candidates, [this](const FIntVector& ChunkCoords)
+		{
+			const FChunkHolder* H = Chunks.FindRef(ChunkCoords);
+			return H ? H->FaceConnections.load(std::memory_order_relaxed) : FChunkVisibility::AllConnected;
+		}, Visible);
+	}
+
+	for (const TPair<FIntVector, TObjectPtr<AChunkActor>>& KV : LoadedChunks)
+	{
+		AChunkActor* CA = KV.Value;
+		if (!IsValid(CA))
+		{
+			continue;
+		}
+		const bool bHidden = bEnableOcclusionCulling && !Visible.Contains(KV.Key);
+		if (CA->IsHidden() != bHidden)
+		{
+			CA->SetActorHiddenInGame(bHidden);
+		}
+	}
+}
+
+/// Choose the LOD level of every rendered chunk from its distance to the closest player.
+/// The reduced mesh is built from the resident blocks, switching level is a mesh-only
+/// rebuild through the dirty path and never runs the generator again
+void UEnigmaWorld::UpdateChunkLods()
+{
+	FReadScopeLock _(ChunksLock);
+	for (auto& KV : Chunks)
+	{
+		FChunkHolder* H = KV.Value;
+		if (!H->IsRendered())
+		{
+			continue;
+		}
+
+		const int32 Distance = GetChunkDistanceToPlayers(KV.Key);
+		SetChunkInRegion(*H, RegionMergeDistance > 0 && Distance >= RegionMergeDistance);
+
+		const uint8 Level    = GetLodLevelForDistance(Distance);
+		const uint8 Previous = H->LodLevel.exchange(Level);
+		if (Previous == Level)
+		{
+			continue;
+		}
+		// Chunks still loading read the new level when the worker meshes them
+		if (H->Stage == EChunkStage::Loaded || H->Stage == EChunkStage::Ready)
+		{
+			H->bDirty            = true;
+			H->bQueuedForRebuild = false;
+		}
+		// Full detail neighbours cull their border faces against this chunk only while it is at full detail too
+		if ((Previous == 0) != (Level == 0))
+		{
+			NotifyNeighborsChunkLoaded(KV.Key);
+		}
+	}
+}
+
+/// Block simulation of the Render and Simulate level chunks. Chunks tick in one parallel batch against the
+/// frozen world (the game thread holds the read lock and writes nothing meanwhile), their
+/// results are then applied in chunk order so a run replays identically
+void UEnigmaWorld::TickBlocks()
+{
+	// The server simulates, a client only receives the changes
+	if (IsNetClient())
+	{
+		return;
+	}
+	++BlockTickCount;
+
+	TArray<FChunkHolder*>    Ticking;
+	TArray<FBlockTickResult> Results;
+	{
+		FReadScopeLock _(ChunksLock);
+		for (const TPair<FIntVector, FChunkHolder*>& KV : Chunks)
+		{
+			FChunkHolder* H = KV.Value;
+			if (H->IsSimulated() && H->bDataReady && (!H->IsEmpty() || H->ScheduledTicks.Num() > 0))
+			{
+				Ticking.Add(H);
+			}
+		}
+		if (Ticking.IsEmpty())
+		{
+			return;
+		}
+		Ticking.Sort([](const FChunkHolder& A, const FChunkHolder& B)
+		{
+			return A.Coords.X != B.Coords.X ? A.Coords.X < B.Coords.X : A.Coords.Y < B.Coords.Y;
+		});
+
+		Results.SetNum(Ticking.Num());
+		auto Lookup = [this](const FIntVector& BlockPos)
+		{
+			return FindBlockUnlocked(BlockPos);
+		};
+		ParallelFor(Ticking.Num(), [this, &Ticking, &Results, &Lookup](int32 Index)
+		{
+			FBlockTickScheduler::TickChunk(*Ticking[Index], BlockTickCount, RandomTicksPerChunk, Lookup, Results[Index]);
+		});
+	}
+
+	// Changes take the edit path (relight, remesh), new ticks get their sequence in chunk order
+	for (const FBlockTickResult& Result : Results)
+	{
+		PendingBlockEdits.Append(Result.Changes);
+		for (const TPair<FIntVector, int32>& Schedule : Result.Schedules)
+		{
+			ScheduleBlockTick(Schedule.Key, Schedule.Value);
+		}
+	}
+}
+
+/// Apply the queued block edits of the chunks no worker reads: no build in flight and no
+/// light stage covering the chunk. The edits of a busy chunk wait for a later tick, in order
+void UEnigmaWorld::ApplyBlockEdits()
+{
+	if (PendingBlockEdits.IsEmpty())
+	{
+		return;
+	}
+
+	FWriteScopeLock _(ChunksLock);
+	TArray<TPair<FIntVector, UBlockDefinition*>> Deferred;
+	TSet<const FChunkHolder*>                    Busy;
+	for (const TPair<FIntVector, UBlockDefinition*>& Edit : PendingBlockEdits)
+	{
+		const FIntVector ChunkCoords = FVoxelCoords::BlockToChunk(Edit.Key);
+		FChunkHolder*    H           = Chunks.FindRef(ChunkCoords);
+		if (!H || !H->bDataReady)
+		{
+			continue; // Evicted since, the edit is dropped
+		}
+		if (Busy.Contains(H) || H->LightStageCount > 0 || (H->BuildFuture.IsValid() && !H->BuildFuture->IsReady()))
+		{
+			Busy.Add(H);
+			Deferred.Add(Edit);
+			continue;
+		}
+
+		SetBlockUnlocked(*H, FVoxelCoords::BlockToLocal(Edit.Key), Edit.Value);
+	}
+	PendingBlockEdits = MoveTemp(Deferred);
+}
+
+void UEnigmaWorld::SetBlockUnlocked(FChunkHolder& H, const FIntVector& LocalCoords, UBlockDefinition* Definition)
+{
+	H.SetBlock(LocalCoords, FBlock(LocalCoords, Definition));
+	H.PendingLightEdits.Add(LocalCoords);
+
+	// Streamed to the clients holding the chunk by the next UpdateChunkStreams
+	if (!ChunkStreams.IsEmpty() && !IsNetClient())
+	{
+		NetBlockChanges.FindOrAdd(H.Coords).Add({FChunkLayout::Index(LocalCoords), H.GetBlockID(LocalCoords)});
+	}
+
+	// The chunk and the neighbours whose border faces or AO see the block
+	const int32 MinX = LocalCoords.X == 0 ? -1 : 0;
+	const int32 MaxX = LocalCoords.X == FChunkLayout::SizeX - 1 ? 1 : 0;
+	const int32 MinY = LocalCoords.Y == 0 ? -1 : 0;
+	const int32 MaxY = LocalCoords.Y == FChunkLayout::SizeY - 1 ? 1 : 0;
+	for (int32 dy = MinY; dy <= MaxY; ++dy)
+	{
+		for (int32 dx = MinX; dx <= MaxX; ++dx)
+		{
+			FChunkHolder* N = Chunks.FindRef(H.Coords + FIntVector(dx, dy, 0));
+			if (N && (N->Stage == EChunkStage::Loaded || N->Stage == EChunkStage::Ready))
+			{
+				N->bDirty            = true;
+				N->bQueuedForRebuild = false;
+			}
+		}
+	}
+}
+
+/// Client: apply the packets streamed by the server in arrival order, like the block edits
+/// only on idle chunks. A full packet replaces the blocks and relights the chunk, a delta
+/// takes the edit path. Packets of a chunk the client does not hold are reported as dropped
+void UEnigmaWorld::ApplyChunkPackets()
+{
+	if (ReceivedChunkPackets.IsEmpty())
+	{
+		return;
+	}
+
+	FWriteScopeLock _(ChunksLock);
+	TArray<TArray<uint8>> Deferred;
+	TSet<FIntVector>      Busy;
+	for (TArray<uint8>& Packet : ReceivedChunkPackets)
+	{
+		FChunkPacket::EType Type;
+		FIntVector          ChunkCoords;
+		if (!FChunkPacket::ReadHeader(Packet, Type, ChunkCoords))
+		{
+			UE_LOG(LogEnigmaVoxelNet, Warning, TEXT("Dropped a chunk packet with a bad header (%d bytes)"), Packet.Num());
+			continue;
+		}
+		FChunkHolder* H = Chunks.FindRef(ChunkCoords);
+		if (!H)
+		{
+			DroppedChunks.AddUnique(ChunkCoords);
+			continue;
+		}
+		if (Busy.Contains(ChunkCoords) || H->LightStageCount > 0 || (H->BuildFuture.IsValid() && !H->BuildFuture->IsReady()))
+		{
+			Busy.Add(ChunkCoords);
+			Deferred.Add(MoveTemp(Packet));
+			continue;
+		}
+		if (Type == FChunkPacket::EType::Delta && !H->bDataReady)
+		{
+			DroppedChunks.AddUnique(ChunkCoords); // Its full packet was dropped, the change is in the next one
+			continue;
+		}
+
+		if (Type == FChunkPacket::EType::Delta)
+		{
+			TArray<FChunkBlockChange> Changes;
+			if (!FChunkPacket::ReadDelta(Packet, Changes))
+			{
+				DroppedChunks.AddUnique(ChunkCoords); // Out of sync, ask for the whole chunk
+				continue;
+			}
+			// The whole record lands before the next flush, the chunk is remeshed and relit once
+			for (const FChunkBlockChange& Change : Changes)
+			{
+				const int32      Index = Change.Index;
+				const FIntVector Local(Index & (FChunkLayout::SizeX - 1), (Index >> FChunkLayout::ShiftY) & (FChunkLayout::SizeY - 1), Index >> FChunkLayout::ShiftZ);
+				SetBlockUnlocked(*H, Local, FChunkHolder::ResolveBlockID(Change.BlockID));
+			}
+			continue;
+		}
+
+		if (!FChunkPacket::ReadChunk(Packet, *H))
+		{
+			UE_LOG(LogEnigmaVoxelNet, Warning, TEXT("Chunk packet -> %s could not be read"), *ChunkCoords.ToString());
+			DroppedChunks.AddUnique(ChunkCoords);
+			continue;
+		}
+		H->bDataReady = true;
+		H->bLit       = false;
+		H->PendingLightEdits.Reset();
+		if (H->Stage == EChunkStage::Loading)
+		{
+			// The worker only meshes it, then publishes the Ready stage
+			ChunkWorkerPool->EnqueueBuildTask(H, /*bMeshOnly=*/true, this);
+		}
+		else if (H->Stage == EChunkStage::Loaded || H->Stage == EChunkStage::Ready)
+		{
+			H->bDirty            = true;
+			H->bQueuedForRebuild = false;
+		}
+		NotifyNeighborsChunkLoaded(ChunkCoords);
+	}
+	ReceivedChunkPackets = MoveTemp(Deferred);
+}
+
+/// Server: stream the chunks and this tick's block changes to every remote client. Client:
+/// report the chunks dropped since the last tick
+void UEnigmaWorld::UpdateChunkStreams(double Now)
+{
+	ChunkStreams.RemoveAll([](const TWeakObjectPtr<UChunkStreamComponent>& Stream)
+	{
+		return !Stream.IsValid();
+	});
+
+	if (IsNetClient())
+	{
+		for (const TWeakObjectPtr<UChunkStreamComponent>& Stream : ChunkStreams)
+		{
+			const APlayerController* PC = Cast<APlayerController>(Stream->GetOwner());
+			if (PC && PC->IsLocalController())
+			{
+				Stream->ReportDroppedChunks(DroppedChunks);
+				break;
+			}
+		}
+		DroppedChunks.Reset();
+		return;
+	}
+
+	// One change record per touched chunk, encoded once for every client holding it. A large
+	// change (explosion, fill) is cheaper as the whole chunk, its runs stay short while the
+	// record grows with every block
+	TMap<FIntVector, TArray<uint8>> ChangePackets;
+	for (TPair<FIntVector, TArray<FChunkBlockChange>>& Record : NetBlockChanges)
+	{
+		FChunkPacket::CoalesceChanges(Record.Value);
+		TArray<uint8>& Packet = ChangePackets.Add(Record.Key);
+		if (Record.Value.Num() <= MaxDeltaBlockChanges || !EncodeChunkPacket(Record.Key, Packet))
+		{
+			FChunkPacket::WriteDelta(Record.Key, Record.Value, Packet);
+		}
+	}
+	for (const TWeakObjectPtr<UChunkStreamComponent>& Stream : ChunkStreams)
+	{
+		Stream->StreamChunks(*this, ChangePackets, Now);
+	}
+	NetBlockChanges.Reset();
+}
+
+/// Light the chunks without light and relight the edited ones. A stage reads and writes the
+/// 3x3 chunks around its chunk, so chunks 3 apart never share one: every tick starts the
+/// chunks of one (X mod 3, Y mod 3) phase in parallel, the next phase waits for them to finish
+void UEnigmaWorld::ScheduleLightStages()
+{
+	if (RunningLightStages > 0 || !ChunkWorkerPool)
+	{
+		return;
+	}
+
+	FReadScopeLock _(ChunksLock);
+	for (int32 Attempt = 0; Attempt < 9; ++Attempt)
+	{
+		LightPhase = (LightPhase + 1) % 9;
+
+		TArray<FChunkHolder*> Batch;
+		for (const TPair<FIntVector, FChunkHolder*>& KV : Chunks)
+		{
+			FChunkHolder* H = KV.Value;
+			if (!H->bDataReady || (H->bLit && H->PendingLightEdits.IsEmpty()))
+			{
+				continue;
+			}
+			const int32 Phase = (H->Coords.X % 3 + 3) % 3 + (H->Coords.Y % 3 + 3) % 3 * 3;
+			if (Phase == LightPhase)
+			{
+				Batch.Add(H);
+			}
+		}
+		if (Batch.IsEmpty())
+		{
+			continue;
+		}
+
+		for (FChunkHolder* H : Batch)
+		{
+			// Chunks still generating are left out, their first light pulls ours in. A chunk being
+			// meshed reads the light, the stage waits for a later phase
+			FLightNeighbourhood Neighbourhood;
+			bool                bMeshing = false;
+			for (int32 dy = -1; dy <= 1 && !bMeshing; ++dy)
+			{
+				for (int32 dx = -1; dx <= 1 && !bMeshing; ++dx)
+				{
+					FChunkHolder* N = Chunks.FindRef(H->Coords + FIntVector(dx, dy, 0));
+					if (N && N->bDataReady)
+					{
+						Neighbourhood.Chunks[FLightNeighbourhood::GetSlot(FIntVector(dx, dy, 0))] = N;
+						bMeshing = N->BuildFuture.IsValid() && !N->BuildFuture->IsReady();
+					}
+				}
+			}
+			if (bMeshing)
+			{
+				continue;
+			}
+			FChunkLight::AllocateStorage(*H);
+			for (FChunkHolder* N : Neighbourhood.Chunks)
+			{
+				if (N)
+				{
+					++N->LightStageCount;
+				}
+			}
+
+			const bool         bFirstLight = !H->bLit;
+			TArray<FIntVector> Edits       = MoveTemp(H->PendingLightEdits);
+			++RunningLightStages;
+			ChunkWorkerPool->EnqueueTask([this, Neighbourhood, Edits = MoveTemp(Edits), bFirstLight]() mutable
+			{
+				if (bFirstLight)
+				{
+					FChunkLight::LightChunk(Neighbourhood);
+				}
+				else
+				{
+					FChunkLight::UpdateBlocks(Neighbourhood, Edits);
+				}
+
+				// The face light is baked in the mesh, remesh every chunk the stage changed
+				for (int32 Slot = 0; Slot < 9; ++Slot)
+				{
+					FChunkHolder* N = Neighbourhood.Chunks[Slot];
+					if (N && (Neighbourhood.ChangedMask & (1 << Slot)) && (N->Stage == EChunkStage::Loaded || N->Stage == EChunkStage::Ready))
+					{
+						N->bDirty            = true;
+						N->bQueuedForRebuild = false;
+					}
+				}
+				for (FChunkHolder* N : Neighbourhood.Chunks)
+				{
+					if (N)
+					{
+						--N->LightStageCount;
+					}
+				}
+				--RunningLightStages;
+			});
+		}
+		return;
+	}
+}
+
+FIntVector UEnigmaWorld::GetRegionCoords(const FIntVector& ChunkCoords) const
+{
+	const int32 Size = FMath::Max(1, RegionClusterChunks);
+	return FIntVector(FloorDiv(ChunkCoords.X, Size), FloorDiv(ChunkCoords.Y, Size), 0);
+}
+
+void UEnigmaWorld::SetChunkInRegion(FChunkHolder& H, bool bInRegion)
+{
+	if (H.bInRegion == bInRegion)
+	{
+		return;
+	}
+	H.bInRegion = bInRegion;
+	if (!bInRegion && RegionMembers.Remove(H.Coords) > 0)
+	{
+		DirtyRegions.Add(GetRegionCoords(H.Coords));
+	}
+
+	// Upload the current mesh again to its new owner. A running build uploads once done, the
+	// holder mesh must not be read before that
+	const bool bBuilding = H.BuildFuture.IsValid() && !H.BuildFuture->IsReady();
+	if (H.Stage == EChunkStage::Loaded && !bBuilding)
+	{
+		H.Stage = EChunkStage::Ready;
+	}
+}
+
+void UEnigmaWorld::ReleaseChunkRender(FChunkHolder& H)
+{
+	if (AChunkActor* CA = LoadedChunks.FindRef(H.Coords))
+	{
+		ReleaseChunkActor(CA);
+		LoadedChunks.Remove(H.Coords);
+	}
+	if (RegionMembers.Remove(H.Coords) > 0)
+	{
+		DirtyRegions.Add(GetRegionCoords(H.Coords));
+	}
+	H.bInRegion = false;
+}
+
+/// Merge the dirty region clusters on the workers and swap the finished merges into their
+/// actor. A region is only merged again when one of its members joined, left or was
+/// re-uploaded, one merge per region at a time
+void UEnigmaWorld::UpdateRegions()
+{
+	for (auto It = RegionMerges.CreateIterator(); It; ++It)
+	{
+		FRegionMesh& Merge = *It.Value();
+		if (!Merge.bReady.load(std::memory_order_acquire))
+		{
+			continue;
+		}
+		TObjectPtr<ARegionActor>& RA = RegionActors.FindOrAdd(It.Key());
+		if (!IsValid(RA))
+		{
+			FActorSpawnParameters P;
+			P.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+			const FVector Origin             = ToRebasedWorldPos(FVoxelCoords::ChunkToWorld(It.Key() * RegionClusterChunks));
+			RA                               = CurrentUWorld->SpawnActor<ARegionActor>(ARegionActor::StaticClass(), Origin, FRotator::ZeroRotator, P);
+		}
+		if (RA)
+		{
+			RA->UpdateRegionMesh(Merge);
+		}
+		It.RemoveCurrent();
+	}
+
+	if (DirtyRegions.Num() == 0)
+	{
+		return;
+	}
+
+	TMap<FIntVector, TArray<TSharedPtr<const FRegionMember>>> Members;
+	for (const TPair<FIntVector, TSharedPtr<const FRegionMember>>& KV : RegionMembers)
+	{
+		const FIntVector Region = GetRegionCoords(KV.Key);
+		if (DirtyRegions.Contains(Region))
+		{
+			Members.FindOrAdd(Region).Add(KV.Value);
+		}
+	}
+
+	for (auto It = DirtyRegions.CreateIterator(); It; ++It)
+	{
+		const FIntVector Region = *It;
+		if (RegionMerges.Contains(Region))
+		{
+			continue; // Still merging, stay dirty for the next tick
+		}
+		It.RemoveCurrent();
+
+		TArray<TSharedPtr<const FRegionMember>>* RegionMemberList = Members.Find(Region);
+		if (!RegionMemberList)
+		{
+			// Last member left
+			TObjectPtr<ARegionActor> RA;
+			if (RegionActors.RemoveAndCopyValue(Region, RA) && IsValid(RA))
+			{
+				RA->Destroy();
+			}
+			continue;
+		}
+
+		TSharedPtr<FRegionMesh> Merge = MakeShared<FRegionMesh>();
+		Merge->Coords                 = Region;
+		RegionMerges.Add(Region, Merge);
+		ChunkWorkerPool->EnqueueTask([Merge, MemberList = MoveTemp(*RegionMemberList)]()
+		{
+			FRegionMesh::Merge(*Merge, MemberList);
+		});
+	}
+}
+
+int32 UEnigmaWorld::GetChunkDistanceToPlayers(const FIntVector& ChunkCoords) const
+{
+	int32 Distance = MAX_int32;
+	for (const FIntVector& Center : PlayerChunkCenters)
+	{
+		const FIntVector Delta = ChunkCoords - Center;
+		Distance               = FMath::Min(Distance, FMath::Max(FMath::Abs(Delta.X), FMath::Abs(Delta.Y)));
+	}
+	return Distance;
 }
 
-void UEnigmaWorld::Tick()
+uint8 UEnigmaWorld::GetLodLevelForDistance(int32 ChunkDistance) const
 {
-	if (!CurrentUWorld)
+	if (LodDistance4x > 0 && ChunkDistance >= LodDistance4x)
 	{
-		return;
+		return 2;
 	}
-	const double Now = FPlatformTime::Seconds();
-
-	// Collect the field of view of this tick
-	TSet<FIntVector> Desired;
-	GatherPlayerVisibleSet(Desired);
-
-	// Add / subtract tickets -> submit task/unload
-	ProcessTickets(Desired, Now);
-
-	// Thread pool result → Generate or update Actor
-	PumpWorkerResults();
-
-	// Handle bDirty reconstruction & actually destroy the expired PendingUnload block
-	FlushDirtyAndPending(Now);
-
-	// Save the collection for next tick difference
-	PrevVisibleSet = MoveTemp(Desired);
+	if (LodDistance2x > 0 && ChunkDistance >= LodDistance2x)
+	{
+		return 1;
+	}
+	return 0;
 }
 
-void UEnigmaWorld::ProcessTickets(const TSet<FIntVector>& Desired, double Now)
+/// Stream the far horizon: tiles around the players, past the chunk view square and up to
+/// HorizonRadius, are built on the workers nearest ring first, then handed to the horizon actor
+void UEnigmaWorld::UpdateHorizon()
 {
-	TSet<FIntVector> ToLoad   = Desired.Difference(PrevVisibleSet);
-	TSet<FIntVector> ToUnload = PrevVisibleSet.Difference(Desired);
-
-	FScopeLock _(&ChunksMutex);
+	const int32 TileChunks = FMath::Max(1, HorizonTileChunks);
+	const int32 CellBlocks = FMath::Clamp(HorizonCellBlocks, 1, TileChunks * ChunkBlockXCount);
 
-	// Add tickets & possibly schedule tasks
-	for (const FIntVector& C : ToLoad)
+	// Wanted tiles with the ring they are in, a tile fully inside the view square is covered by the real chunks
+	TMap<FIntVector, int32> Desired;
+	if (HorizonRadius > ViewRadius)
 	{
-		FChunkHolder* H = nullptr;
-		if (TUniquePtr<FChunkHolder>* Ptr = Chunks.Find(C))
+		for (const FIntVector& Center : PlayerChunkCenters)
 		{
-			H = Ptr->Get();
-		}
-		else
-		{
-			H = Chunks.Add(C, MakeUnique<FChunkHolder>()).Get();
+			const FIntVector CenterTile(FloorDiv(Center.X, TileChunks), FloorDiv(Center.Y, TileChunks), 0);
+			const FIntVector MinTile(FloorDiv(Center.X - HorizonRadius, TileChunks), FloorDiv(Center.Y - HorizonRadius, TileChunks), 0);
+			const FIntVector MaxTile(FloorDiv(Center.X + HorizonRadius, TileChunks), FloorDiv(Center.Y + HorizonRadius, TileChunks), 0);
+			for (int32 ty = MinTile.Y; ty <= MaxTile.Y; ++ty)
+			{
+				for (int32 tx = MinTile.X; tx <= MaxTile.X; ++tx)
+				{
+					const FIntVector First(tx * TileChunks - Center.X, ty * TileChunks - Center.Y, 0);
+					const FIntVector Last = First + FIntVector(TileChunks - 1, TileChunks - 1, 0);
+					if (First.X >= -ViewRadius && First.Y >= -ViewRadius && Last.X <= ViewRadius && Last.Y <= ViewRadius)
+					{
+						continue;
+					}
+					const FIntVector Tile(tx, ty, 0);
+					const int32      Ring     = FMath::Max(FMath::Abs(tx - CenterTile.X), FMath::Abs(ty - CenterTile.Y));
+					const int32*     Existing = Desired.Find(Tile);
+					Desired.Add(Tile, Existing ? FMath::Min(*Existing, Ring) : Ring);
+				}
+			}
 		}
+	}
 
-		H->Coords = C;
-		H->AddTicket();
+	if (!HorizonActor && Desired.Num() > 0)
+	{
+		FActorSpawnParameters P;
+		P.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+		HorizonActor = CurrentUWorld->SpawnActor<AHorizonActor>(AHorizonActor::StaticClass(), ToRebasedWorldPos(FVector::ZeroVector), FRotator::ZeroRotator, P);
+	}
+	if (!HorizonActor)
+	{
+		return;
+	}
 
-		if (H->Stage == EChunkStage::Loading)
+	// Out of range, the worker may still hold a tile being built, it is dropped with its last reference
+	for (auto It = HorizonTiles.CreateIterator(); It; ++It)
+	{
+		if (!Desired.Contains(It.Key()))
 		{
-			ChunkWorkerPool->EnqueueBuildTask(H, false, this);
+			HorizonActor->RemoveTile(It.Key());
+			It.RemoveCurrent();
 		}
 	}
 
-	// Reduce ticket (leave the field of view once)
-	for (const FIntVector& C : ToUnload)
+	// The worker queue is FIFO, submit the inner rings first
+	Desired.ValueSort(TLess<int32>());
+	const float BlockSize = BlockWorldSize;
+	for (const TPair<FIntVector, int32>& KV : Desired)
 	{
-		if (TUniquePtr<FChunkHolder>* Ptr = Chunks.Find(C))
+		if (HorizonTiles.Contains(KV.Key))
 		{
-			(*Ptr)->RemoveTicket(Now, GracePeriod);
+			continue;
 		}
+		TSharedPtr<FHorizonTile> Tile = MakeShared<FHorizonTile>();
+		Tile->Coords                  = KV.Key;
+		HorizonTiles.Add(KV.Key, Tile);
+		ChunkWorkerPool->EnqueueTask([Tile, TileChunks, CellBlocks, BlockSize]()
+		{
+			FHorizonTile::Build(*Tile, TileChunks, CellBlocks, BlockSize);
+		});
 	}
-}
-
-
-void UEnigmaWorld::PumpWorkerResults()
-{
-	FScopeLock _(&ChunksMutex);
 
-	for (auto& KV : Chunks)
+	FBlock SurfaceBlock(FIntVector::ZeroValue, FWorldGen::SampleSurfaceBlock(0, 0));
+	for (TPair<FIntVector, TSharedPtr<FHorizonTile>>& KV : HorizonTiles)
 	{
-		FChunkHolder* H = KV.Value.Get();
-		if (H->Stage != EChunkStage::Ready)
+		FHorizonTile& Tile = *KV.Value;
+		if (Tile.bUploaded || !Tile.bReady.load(std::memory_order_acquire))
 		{
 			continue;
 		}
-
-		AsyncTask(ENamedThreads::GameThread, [this, Coords = KV.Key, H]()
-		{
-			AChunkActor* CA = LoadedChunks.FindRef(Coords);
-			if (!CA)
-			{
-				FActorSpawnParameters P;
-				P.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
-				FVector Origin((float)Coords.X * 1600.f, (float)Coords.Y * 1600.f, 0.f); // TODO: Parameterize the statement
-				CA = CurrentUWorld->SpawnActor<AChunkActor>(
-					AChunkActor::StaticClass(), Origin, FRotator::ZeroRotator, P);
-				LoadedChunks.Add(Coords, CA);
-			}
-
-			UDynamicMesh* DynMesh = CA->GetDynamicMeshComponent()->GetDynamicMesh();
-			DynMesh->GetMeshRef() = CopyTemp(H->Mesh);
-			CA->UpdateChunkMaterial(*H);
-
-			H->Stage = EChunkStage::Loaded;
-			if (H->bNeedsNeighborNotify.exchange(false, std::memory_order_relaxed))
-			{
-				NotifyNeighborsChunkLoaded(Coords);
-			}
-		});
+		const FVector TileOrigin = FVoxelCoords::ChunkToWorld(FIntVector(KV.Key.X * TileChunks, KV.Key.Y * TileChunks, 0));
+		HorizonActor->SetTile(KV.Key, TileOrigin, MoveTemp(Tile.Mesh), SurfaceBlock.GetFacesMaterial(EBlockDirection::UP));
+		Tile.bUploaded = true;
 	}
 }
 
@@ -173,9 +1099,86 @@ bool UEnigmaWorld::SetUWorldTarget(UWorld* UnrealBuildInWorld)
 	{
 		return false;
 	}
+	// Nobody looks at a dedicated server, keep the chunk data and simulation only
+	if (CurrentUWorld->GetNetMode() == NM_DedicatedServer)
+	{
+		bDataOnlyMode = true;
+		UE_LOG(LogEnigmaVoxelWorld, Display, TEXT("Dedicated server, the Enigma world runs data-only"));
+	}
+	return true;
+}
+
+bool UEnigmaWorld::IsNetClient() const
+{
+	return CurrentUWorld && CurrentUWorld->GetNetMode() == NM_Client;
+}
+
+int32 UEnigmaWorld::GetTicketRadius() const
+{
+	return FMath::Max(0, ViewRadius) + FMath::Max(0, SimulationRingChunks) + FMath::Max(0, DataRingChunks);
+}
+
+void UEnigmaWorld::RegisterChunkStream(UChunkStreamComponent* Stream)
+{
+	ChunkStreams.AddUnique(Stream);
+}
+
+void UEnigmaWorld::UnregisterChunkStream(UChunkStreamComponent* Stream)
+{
+	ChunkStreams.Remove(Stream);
+}
+
+bool UEnigmaWorld::EncodeChunkPacket(const FIntVector& ChunkCoords, TArray<uint8>& OutPacket) const
+{
+	FReadScopeLock _(ChunksLock);
+	const FChunkHolder* H = Chunks.FindRef(ChunkCoords);
+	if (!H || !H->bDataReady)
+	{
+		return false;
+	}
+	FChunkPacket::WriteChunk(*H, OutPacket);
 	return true;
 }
 
+void UEnigmaWorld::ReceiveChunkPacket(const TArray<uint8>& Packet)
+{
+	ReceivedChunkPackets.Add(Packet);
+}
+
+void UEnigmaWorld::LogWorldStats() const
+{
+	int32 LevelCounts[4]    = {};
+	int32 CollisionBoxCount = 0;
+	{
+		FReadScopeLock _(ChunksLock);
+		for (const TPair<FIntVector, FChunkHolder*>& KV : Chunks)
+		{
+			++LevelCounts[static_cast<uint8>(KV.Value->TicketLevel.load())];
+			CollisionBoxCount += KV.Value->CollisionBoxes.Num();
+		}
+	}
+
+	UE_LOG(LogEnigmaVoxelWorld, Display, TEXT("Enigma world %s (%s): %d chunks resident (%d render, %d simulate, %d data-only, %d unticketed), %.1f / %d MB, %d collision boxes, %d chunk actors (%d pooled), %d region actors"),
+	       *GetName(), bDataOnlyMode ? TEXT("data-only") : TEXT("rendered"), Chunks.Num(),
+	       LevelCounts[static_cast<uint8>(EChunkTicketLevel::Render)], LevelCounts[static_cast<uint8>(EChunkTicketLevel::Simulate)],
+	       LevelCounts[static_cast<uint8>(EChunkTicketLevel::DataOnly)], LevelCounts[static_cast<uint8>(EChunkTicketLevel::None)],
+	       ResidentBytes / (1024.0 * 1024.0), ResidentMemoryBudgetMB, CollisionBoxCount, LoadedChunks.Num(), ChunkActorPool.Num(), RegionActors.Num());
+}
+
+static FAutoConsoleCommand GWorldStatsCommand(
+	TEXT("Enigma.WorldStats"),
+	TEXT("Log the resident chunks of every Enigma world per ticket level, their memory and render objects. Works on a headless server"),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		for (TObjectIterator<UEnigmaWorld> It; It; ++It)
+		{
+			if (!It->HasAnyFlags(RF_ClassDefaultObject))
+			{
+				It->LogWorldStats();
+			}
+		}
+	}));
+
 bool UEnigmaWorld::SetEnableWorldTick(bool Enable)
 {
 	EnableWorldTick = Enable;
@@ -205,9 +1208,8 @@ void UEnigmaWorld::NotifyNeighborsChunkLoaded(FIntVector ChunkCoords)
 
 	for (const FIntVector& O : Offsets)
 	{
-		if (TUniquePtr<FChunkHolder>* Ptr = Chunks.Find(ChunkCoords + O))
+		if (FChunkHolder* N = Chunks.FindRef(ChunkCoords + O))
 		{
-			FChunkHolder* N = Ptr->Get();
 			if (N->Stage == EChunkStage::Loaded || N->Stage == EChunkStage::Ready)
 			{
 				N->bDirty            = true;
@@ -252,6 +1254,18 @@ bool UEnigmaWorld::RemoveEntity(APawn* InEntity)
 	return true;
 }
 
+bool UEnigmaWorld::AddForcedChunk(const FIntVector& ChunkCoords)
+{
+	bool bAlreadyForced = false;
+	ForcedChunks.Add(FIntVector(ChunkCoords.X, ChunkCoords.Y, 0), &bAlreadyForced);
+	return !bAlreadyForced;
+}
+
+bool UEnigmaWorld::RemoveForcedChunk(const FIntVector& ChunkCoords)
+{
+	return ForcedChunks.Remove(FIntVector(ChunkCoords.X, ChunkCoords.Y, 0)) > 0;
+}
+
 void UEnigmaWorld::InitializeChunkWorkerPool()
 {
 	ChunkWorkerPool = NewObject<UChunkWorkerPool>(this, "ChunkWorkerPool");
@@ -266,82 +1280,384 @@ void UEnigmaWorld::ShutdownChunkWorkerPool()
 	}
 }
 
+/// Take a parked actor from the pool and move it to the chunk origin, only
+/// spawn a new one when the pool is empty. Spawning also creates and registers
+/// the collision mesh component, which is what we want to avoid while streaming.
+/// @param ChunkCoords The chunk the actor will represent
+/// @return The actor ready to receive the chunk mesh, nullptr if spawn failed
+AChunkActor* UEnigmaWorld::AcquireChunkActor(const FIntVector& ChunkCoords)
+{
+	const FVector Origin = ToRebasedWorldPos(FVoxelCoords::ChunkToWorld(ChunkCoords));
+
+	while (ChunkActorPool.Num() > 0)
+	{
+		AChunkActor* CA = ChunkActorPool.Pop(EAllowShrinking::No);
+		if (IsValid(CA))
+		{
+			CA->ActivateFromPool(Origin);
+			return CA;
+		}
+	}
+
+	FActorSpawnParameters P;
+	P.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	return CurrentUWorld->SpawnActor<AChunkActor>(AChunkActor::StaticClass(), Origin, FRotator::ZeroRotator, P);
+}
+
+/// Park the actor in the pool, destroy it if the pool already reach the budget
+/// @param ChunkActor The actor that no longer represent a loaded chunk
+void UEnigmaWorld::ReleaseChunkActor(AChunkActor* ChunkActor)
+{
+	if (!IsValid(ChunkActor))
+	{
+		return;
+	}
+	if (ChunkActorPool.Num() >= ChunkActorPoolBudget)
+	{
+		ChunkActor->Destroy();
+		return;
+	}
+	ChunkActor->DeactivateToPool();
+	ChunkActorPool.Add(ChunkActor);
+}
+
 FIntVector UEnigmaWorld::WorldPosToChunkCoords(const FVector& WorldPos)
 {
-	int32 ChunkX = static_cast<int32>(FMath::FloorToInt(WorldPos.X / ChunkWorldSize));
-	int32 ChunkY = static_cast<int32>(FMath::FloorToInt(WorldPos.Y / ChunkWorldSize));
-	return FIntVector(ChunkX, ChunkY, 0);
+	return FVoxelCoords::BlockToChunk(FVoxelCoords::WorldToBlock64(WorldPos));
 }
 
 FIntVector UEnigmaWorld::BlockPosToChunkCoords(const FIntVector& BlockPos)
 {
-	return WorldPosToChunkCoords(FVector(static_cast<float>(BlockPos.X) * BlockWorldSize, static_cast<float>(BlockPos.Y) * BlockWorldSize, static_cast<float>(BlockPos.Z) * BlockWorldSize));
+	return FVoxelCoords::BlockToChunk(BlockPos);
 }
 
 FIntVector UEnigmaWorld::WorldPosToChunkLocalCoords(const FVector& WorldPos)
 {
-	FIntVector chunkCoords = WorldPosToChunkCoords(WorldPos);
-	// Calculate chunkWorldOrigin = (chunkCoords * ChunkWorldSize)
-	FVector chunkWorldOrigin(static_cast<float>(chunkCoords.X) * ChunkWorldSize, static_cast<float>(chunkCoords.Y) * ChunkWorldSize, 0.f);
-	// Then (WorldPos - chunkWorldOrigin) / BlockWorldSize is the local block index relative to the chunk
-	float localBlockX = static_cast<float>(WorldPos.X - chunkWorldOrigin.X) / BlockWorldSize;
-	float localBlockY = static_cast<float>(WorldPos.Y - chunkWorldOrigin.Y) / BlockWorldSize;
-	float localBlockZ = static_cast<float>(WorldPos.Z - chunkWorldOrigin.Z) / BlockWorldSize;
-
-	int32 lx = FMath::FloorToInt(localBlockX); // 0 ~ 15
-	int32 ly = FMath::FloorToInt(localBlockY); // 0 ~ 15
-	int32 lz = FMath::FloorToInt(localBlockZ); // 0 ~ 15
-
-	auto modChunk = [=](int32 v) { return (v % ChunkBlockXCount + ChunkBlockYCount) % ChunkBlockZCount; };
+	return FVoxelCoords::BlockToLocal(FVoxelCoords::WorldToBlock64(WorldPos));
+}
 
-	lx = modChunk(lx);
-	ly = modChunk(ly);
-	lz = modChunk(lz);
+FIntVector UEnigmaWorld::BlockPosToChunkLocalCoords(const FIntVector& BlockPos)
+{
+	return FVoxelCoords::BlockToLocal(BlockPos);
+}
 
-	return FIntVector(lx, ly, lz);
+FVector UEnigmaWorld::ToAbsoluteWorldPos(const FVector& WorldPos) const
+{
+	return CurrentUWorld ? WorldPos + FVector(CurrentUWorld->OriginLocation) : WorldPos;
 }
 
-FIntVector UEnigmaWorld::BlockPosToChunkLocalCoords(const FIntVector& BlockPos)
+FVector UEnigmaWorld::ToRebasedWorldPos(const FVector& AbsoluteWorldPos) const
 {
-	return WorldPosToChunkLocalCoords(FVector(static_cast<float>(BlockPos.X) * BlockWorldSize, static_cast<float>(BlockPos.Y) * BlockWorldSize, static_cast<float>(BlockPos.Z) * BlockWorldSize));
+	return CurrentUWorld ? AbsoluteWorldPos - FVector(CurrentUWorld->OriginLocation) : AbsoluteWorldPos;
 }
 
-UBlockDefinition* UEnigmaWorld::GetBlockAtWorldPos(const FVector& WorldPos)
+/// Move the engine world origin under the first player once it wanders too far, the engine
+/// shifts every actor (chunk actors included) so rendering and physics stay near zero while
+/// the block data keeps its absolute integer coordinates.
+void UEnigmaWorld::RebaseOriginIfNeeded()
 {
-	FIntVector chunkCoords = WorldPosToChunkCoords(WorldPos);
+	if (OriginRebaseDistance <= 0.f || !CurrentUWorld)
+	{
+		return;
+	}
+	const APlayerController* PC = CurrentUWorld->GetFirstPlayerController();
+	const APawn*             P  = PC ? PC->GetPawn() : nullptr;
+	if (!P || P->GetActorLocation().Size2D() < OriginRebaseDistance)
+	{
+		return;
+	}
 
-	// If it does not exist or has not been loaded yet
-	if (!Chunks.Contains(chunkCoords))
+	// Snap to a chunk corner, the engine origin is an int32 vector so clamp far away worlds to its range
+	const FVector    ChunkOrigin = FVoxelCoords::ChunkToWorld(WorldPosToChunkCoords(ToAbsoluteWorldPos(P->GetActorLocation())));
+	const FVector    Clamped     = ChunkOrigin.BoundToCube(static_cast<double>(MAX_int32) - ChunkWorldSize);
+	const FIntVector NewOrigin(static_cast<int32>(Clamped.X), static_cast<int32>(Clamped.Y), CurrentUWorld->OriginLocation.Z);
+	if (NewOrigin != CurrentUWorld->OriginLocation && CurrentUWorld->SetNewWorldOrigin(NewOrigin))
 	{
-		return nullptr; // Indicates that this is "air" or the block does not exist
+		UE_LOG(LogEnigmaVoxelChunk, Log, TEXT("Rebased world origin -> %s"), *NewOrigin.ToString());
 	}
-	FChunkHolder* holder = Chunks[chunkCoords].Get();
-	if (holder->Stage != EChunkStage::Ready && holder->Stage != EChunkStage::Loaded)
+}
+
+UBlockDefinition* UEnigmaWorld::GetBlockAtWorldPos(const FVector& WorldPos)
+{
+	const FInt64Vector blockPos = FVoxelCoords::WorldToBlock64(ToAbsoluteWorldPos(WorldPos));
+	if (blockPos.X < MIN_int32 || blockPos.X > MAX_int32 || blockPos.Y < MIN_int32 || blockPos.Y > MAX_int32)
 	{
-		return nullptr; // The block has not been loaded yet, so it is treated as air.
+		return nullptr;
 	}
+	return GetBlockAtBlockPos(FIntVector(static_cast<int32>(blockPos.X), static_cast<int32>(blockPos.Y), static_cast<int32>(blockPos.Z)));
+}
+
+UBlockDefinition* UEnigmaWorld::GetBlockAtBlockPos(const FIntVector& BlockPos)
+{
+	FReadScopeLock _(ChunksLock);
+	// Air, not generated yet or not loaded => nullptr
+	return FindBlockUnlocked(BlockPos);
+}
 
-	// Get the local coordinates within this block
-	FIntVector localCoords = WorldPosToChunkLocalCoords(WorldPos);
-	// It is best to check if localCoords are all in [0..15]
-	if (localCoords.X < 0 || localCoords.X >= holder->Dimension.X ||
-		localCoords.Y < 0 || localCoords.Y >= holder->Dimension.Y ||
-		localCoords.Z < 0 || localCoords.Z >= holder->Dimension.Z)
+UBlockDefinition* UEnigmaWorld::FindBlockUnlocked(const FIntVector& BlockPos) const
+{
+	if (BlockPos.Z < 0 || BlockPos.Z >= ChunkBlockZCount)
 	{
 		return nullptr;
 	}
 
-	// Get the block here
-	const FBlock& blockData = holder->GetBlock(localCoords);
-	if (!blockData.Definition)
+	const FChunkHolder* holder = Chunks.FindRef(FVoxelCoords::BlockToChunk(BlockPos));
+	if (!holder || !holder->bDataReady)
 	{
 		return nullptr;
 	}
-	return blockData.Definition;
+	return FChunkHolder::ResolveBlockID(holder->GetBlockID(FVoxelCoords::BlockToLocal(BlockPos)));
 }
 
-UBlockDefinition* UEnigmaWorld::GetBlockAtBlockPos(const FIntVector& BlockPos)
+int32 UEnigmaWorld::GetSurfaceHeightAtBlockPos(int32 BlockX, int32 BlockY) const
+{
+	const FIntVector blockPos(BlockX, BlockY, 0);
+
+	FReadScopeLock      _(ChunksLock);
+	const FChunkHolder* holder = Chunks.FindRef(FVoxelCoords::BlockToChunk(blockPos));
+	if (!holder || !holder->bDataReady)
+	{
+		return INDEX_NONE;
+	}
+	const FIntVector local = FVoxelCoords::BlockToLocal(blockPos);
+	return holder->GetColumnHeight(local.X, local.Y);
+}
+
+bool UEnigmaWorld::GetSurfaceAtWorldPos(const FVector& WorldPos, FVector& OutSurfacePos) const
+{
+	const FInt64Vector blockPos = FVoxelCoords::WorldToBlock64(ToAbsoluteWorldPos(WorldPos));
+	if (blockPos.X < MIN_int32 || blockPos.X > MAX_int32 || blockPos.Y < MIN_int32 || blockPos.Y > MAX_int32)
+	{
+		return false;
+	}
+	const int32 height = GetSurfaceHeightAtBlockPos(static_cast<int32>(blockPos.X), static_cast<int32>(blockPos.Y));
+	if (height == INDEX_NONE)
+	{
+		return false;
+	}
+	const FVector absolute((blockPos.X + 0.5) * BlockWorldSize, (blockPos.Y + 0.5) * BlockWorldSize, height * BlockWorldSize);
+	OutSurfacePos = ToRebasedWorldPos(absolute);
+	return true;
+}
+
+bool UEnigmaWorld::ScheduleBlockTick(const FIntVector& BlockPos, int32 DelayTicks)
+{
+	if (BlockPos.Z < 0 || BlockPos.Z >= ChunkBlockZCount)
+	{
+		return false;
+	}
+
+	FReadScopeLock _(ChunksLock);
+	FChunkHolder*  holder = Chunks.FindRef(FVoxelCoords::BlockToChunk(BlockPos));
+	if (!holder || !holder->bDataReady)
+	{
+		return false;
+	}
+	FBlockTickScheduler::Schedule(*holder, FVoxelCoords::BlockToLocal(BlockPos), BlockTickCount + FMath::Max(1, DelayTicks), NextTickSequence++);
+	return true;
+}
+
+bool UEnigmaWorld::SetBlockAtBlockPos(const FIntVector& BlockPos, UBlockDefinition* Definition)
+{
+	if (BlockPos.Z < 0 || BlockPos.Z >= ChunkBlockZCount)
+	{
+		return false;
+	}
+
+	FReadScopeLock      _(ChunksLock);
+	const FChunkHolder* holder = Chunks.FindRef(FVoxelCoords::BlockToChunk(BlockPos));
+	if (!holder || !holder->bDataReady)
+	{
+		return false;
+	}
+	PendingBlockEdits.Emplace(BlockPos, Definition);
+	return true;
+}
+
+void UEnigmaWorld::GetBlockIDsAtBlockPositions(const TArray<FIntVector>& BlockPositions, TArray<int32>& OutBlockIDs) const
+{
+	OutBlockIDs.SetNumUninitialized(BlockPositions.Num());
+
+	FReadScopeLock _(ChunksLock);
+	// Scans are spatially coherent, most consecutive positions fall in the same chunk
+	FIntVector          cachedCoords(MAX_int32);
+	const FChunkHolder* cachedHolder = nullptr;
+	for (int32 i = 0; i < BlockPositions.Num(); ++i)
+	{
+		const FIntVector& blockPos    = BlockPositions[i];
+		const FIntVector  chunkCoords = FVoxelCoords::BlockToChunk(blockPos);
+		if (chunkCoords != cachedCoords)
+		{
+			cachedCoords = chunkCoords;
+			cachedHolder = Chunks.FindRef(chunkCoords);
+			if (cachedHolder && !cachedHolder->bDataReady)
+			{
+				cachedHolder = nullptr;
+			}
+		}
+
+		if (!cachedHolder || blockPos.Z < 0 || blockPos.Z >= FChunkLayout::SizeZ)
+		{
+			OutBlockIDs[i] = INDEX_NONE;
+			continue;
+		}
+		OutBlockIDs[i] = cachedHolder->GetBlockID(FVoxelCoords::BlockToLocal(blockPos));
+	}
+}
+
+void UEnigmaWorld::GetBlockIDsInBox(const FIntVector& MinBlockPos, const FIntVector& MaxBlockPos, TArray<int32>& OutBlockIDs) const
 {
-	FScopeLock _(&ChunksMutex);
-	return GetBlockAtWorldPos(FVector(static_cast<float>(BlockPos.X) * BlockWorldSize, static_cast<float>(BlockPos.Y) * BlockWorldSize, static_cast<float>(BlockPos.Z) * BlockWorldSize));
+	const FIntVector minPos = MinBlockPos.ComponentMin(MaxBlockPos);
+	const FIntVector maxPos = MinBlockPos.ComponentMax(MaxBlockPos);
+	const int32      count  = GetBoxVoxelCount(minPos, maxPos);
+	if (count == 0)
+	{
+		OutBlockIDs.Reset();
+		return;
+	}
+	const FIntVector size = maxPos - minPos + FIntVector(1);
+	OutBlockIDs.Init(INDEX_NONE, count);
+
+	const FIntVector minChunk = FVoxelCoords::BlockToChunk(minPos);
+	const FIntVector maxChunk = FVoxelCoords::BlockToChunk(maxPos);
+
+	FReadScopeLock _(ChunksLock);
+	// Walk chunk by chunk so every chunk is looked up once, then copy its overlap with the box
+	for (int32 cy = minChunk.Y; cy <= maxChunk.Y; ++cy)
+	{
+		for (int32 cx = minChunk.X; cx <= maxChunk.X; ++cx)
+		{
+			const FChunkHolder* holder = Chunks.FindRef(FIntVector(cx, cy, 0));
+			if (!holder || !holder->bDataReady)
+			{
+				continue; // Not loaded, stays INDEX_NONE
+			}
+
+			const FIntVector origin = FVoxelCoords::ChunkToBlock(FIntVector(cx, cy, 0));
+			const FIntVector from   = minPos.ComponentMax(origin);
+			const FIntVector to     = maxPos.ComponentMin(origin + FChunkLayout::GetDimension() - FIntVector(1));
+			for (int32 z = FMath::Max(from.Z, 0); z <= to.Z; ++z)
+			{
+				for (int32 y = from.Y; y <= to.Y; ++y)
+				{
+					for (int32 x = from.X; x <= to.X; ++x)
+					{
+						const int32 index  = (x - minPos.X) + (y - minPos.Y) * size.X + (z - minPos.Z) * size.X * size.Y;
+						OutBlockIDs[index] = holder->GetBlockID(FIntVector(x, y, z) - origin);
+					}
+				}
+			}
+		}
+	}
+}
+
+bool UEnigmaWorld::IsChunkMeshedAtFullDetail(const FIntVector& ChunkCoords) const
+{
+	FReadScopeLock      _(ChunksLock);
+	const FChunkHolder* H = Chunks.FindRef(FIntVector(ChunkCoords.X, ChunkCoords.Y, 0));
+	return !H || (H->LodLevel == 0 && H->MeshLodLevel == 0);
+}
+
+void UEnigmaWorld::GetLightInBox(const FIntVector& MinBlockPos, const FIntVector& MaxBlockPos, TArray<uint8>& OutLight) const
+{
+	const FIntVector minPos = MinBlockPos.ComponentMin(MaxBlockPos);
+	const FIntVector maxPos = MinBlockPos.ComponentMax(MaxBlockPos);
+	const int32      count  = GetBoxVoxelCount(minPos, maxPos);
+	if (count == 0)
+	{
+		OutLight.Reset();
+		return;
+	}
+	const FIntVector size = maxPos - minPos + FIntVector(1);
+	OutLight.Init(FChunkLight::MaxLevel << 4, count);
+
+	const FIntVector minChunk = FVoxelCoords::BlockToChunk(minPos);
+	const FIntVector maxChunk = FVoxelCoords::BlockToChunk(maxPos);
+
+	FReadScopeLock _(ChunksLock);
+	for (int32 cy = minChunk.Y; cy <= maxChunk.Y; ++cy)
+	{
+		for (int32 cx = minChunk.X; cx <= maxChunk.X; ++cx)
+		{
+			const FChunkHolder* holder = Chunks.FindRef(FIntVector(cx, cy, 0));
+			if (!holder || !holder->bLit)
+			{
+				continue; // Not loaded or not lit yet, stays full sky
+			}
+
+			const FIntVector origin = FVoxelCoords::ChunkToBlock(FIntVector(cx, cy, 0));
+			const FIntVector from   = minPos.ComponentMax(origin);
+			const FIntVector to     = maxPos.ComponentMin(origin + FChunkLayout::GetDimension() - FIntVector(1));
+			for (int32 z = FMath::Max(from.Z, 0); z <= to.Z; ++z)
+			{
+				for (int32 y = from.Y; y <= to.Y; ++y)
+				{
+					for (int32 x = from.X; x <= to.X; ++x)
+					{
+						const int32 index = (x - minPos.X) + (y - minPos.Y) * size.X + (z - minPos.Z) * size.X * size.Y;
+						OutLight[index]   = FChunkLight::GetPackedLight(*holder, FChunkHolder::GetBlockIndex(FIntVector(x, y, z) - origin));
+					}
+				}
+			}
+		}
+	}
+}
+
+int32 UEnigmaWorld::GetChunkSectionCount(const FIntVector& ChunkCoords) const
+{
+	FReadScopeLock _(ChunksLock);
+	const FChunkHolder* holder = Chunks.FindRef(ChunkCoords);
+	// The section map is rebuilt by the mesher, only read it once the chunk is uploaded
+	if (!holder || holder->Stage != EChunkStage::Loaded || (holder->BuildFuture.IsValid() && !holder->BuildFuture->IsReady()))
+	{
+		return INDEX_NONE;
+	}
+	return holder->MaterialToSection.Num();
+}
+
+bool UEnigmaWorld::RaycastBlocks(const FVector& Start, const FVector& Direction, float MaxDistance, FVoxelRaycastHit& OutHit) const
+{
+	check(IsInGameThread());
+	const bool bHit = RaycastBlocksAbsolute(ToAbsoluteWorldPos(Start), Direction, MaxDistance, OutHit);
+	OutHit.Location = ToRebasedWorldPos(OutHit.Location);
+	return bHit;
+}
+
+FVector UEnigmaWorld::SweepBlocks(const FBox& Box, const FVector& Delta) const
+{
+	check(IsInGameThread());
+	return SweepBlocksAbsolute(Box.ShiftBy(ToAbsoluteWorldPos(FVector::ZeroVector)), Delta);
+}
+
+bool UEnigmaWorld::OverlapBlocks(const FBox& Box) const
+{
+	check(IsInGameThread());
+	return OverlapBlocksAbsolute(Box.ShiftBy(ToAbsoluteWorldPos(FVector::ZeroVector)));
+}
+
+bool UEnigmaWorld::RaycastBlocksAbsolute(const FVector& Start, const FVector& Direction, float MaxDistance, FVoxelRaycastHit& OutHit) const
+{
+	FReadScopeLock _(ChunksLock);
+	return FVoxelQuery::Raycast(Start, Direction, MaxDistance, BlockWorldSize, [this](const FIntVector& BlockPos)
+	{
+		return FindBlockUnlocked(BlockPos);
+	}, OutHit);
+}
+
+FVector UEnigmaWorld::SweepBlocksAbsolute(const FBox& Box, const FVector& Delta) const
+{
+	FReadScopeLock _(ChunksLock);
+	return FVoxelQuery::SweepAABB(Box, Delta, BlockWorldSize, [this](const FIntVector& BlockPos)
+	{
+		return FindBlockUnlocked(BlockPos);
+	});
+}
+
+bool UEnigmaWorld::OverlapBlocksAbsolute(const FBox& Box) const
+{
+	FReadScopeLock _(ChunksLock);
+	return FVoxelQuery::OverlapAABB(Box, BlockWorldSize, [this](const FIntVector& BlockPos)
+	{
+		return FindBlockUnlocked(BlockPos);
+	});
 }
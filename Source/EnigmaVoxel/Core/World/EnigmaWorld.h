@@ -3,12 +3,23 @@
 #include "CoreMinimal.h"
 #include "Containers/Deque.h"
 #include "EnigmaVoxel/Modules/Chunk/ChunkActor.h"
+#include "EnigmaVoxel/Modules/Chunk/ChunkHolderPool.h"
+#include "EnigmaVoxel/Modules/Chunk/ChunkPacket.h"
+#include "EnigmaVoxel/Modules/Chunk/ChunkWarmCache.h"
+#include "Query/VoxelQuery.h"
 #include "UObject/Object.h"
 #include "EnigmaWorld.generated.h"
 
 enum class ETicketType : uint8;
+enum class EChunkTicketLevel : uint8;
 struct FChunkHolder;
+struct FHorizonTile;
+class AHorizonActor;
+struct FRegionMember;
+struct FRegionMesh;
+class ARegionActor;
 class UChunkWorkerPool;
+class UChunkStreamComponent;
 /**
 * UEnigmaWorld is used as a "logic and data manager" to maintain the data structure of Chunk internally, and then delegates UWorld to generate real Actor when display or collision is required.
 * This design is also very similar to Minecraft or NeoForge Mod: "world data" (your UEnigmaWorld) + "underlying real world" (Unreal's UWorld).
@@ -29,10 +40,22 @@ public:
 
 	/// Life Hool Functions
 	void Tick();
-	void GatherPlayerVisibleSet(TSet<FIntVector>& Out);
-	void ProcessTickets(const TSet<FIntVector>& Desired, double Now);
+	void GatherTicketLevels(TMap<FIntVector, EChunkTicketLevel>& Out);
+	void ProcessTickets(const TMap<FIntVector, EChunkTicketLevel>& Desired, double Now);
 	void PumpWorkerResults();
+	void UploadChunkToActor(FChunkHolder& H);
 	void FlushDirtyAndPending(double Now);
+	void EvictOverBudget();
+	void RebaseOriginIfNeeded();
+	void UpdateChunkVisibility();
+	void UpdateChunkLods();
+	void UpdateHorizon();
+	void UpdateRegions();
+	void TickBlocks();
+	void ApplyBlockEdits();
+	void ScheduleLightStages();
+	void ApplyChunkPackets();
+	void UpdateChunkStreams(double Now);
 
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="Chunk")
 	TMap<FIntVector, TObjectPtr<AChunkActor>> LoadedChunks;
@@ -46,8 +69,17 @@ public:
 	bool SetEnableWorldTick(bool Enable = true);
 	UFUNCTION(BlueprintCallable, Category="World")
 	bool GetEnableWorldTick();
+	/// Data and simulation only, no mesh, material, chunk actor, region nor horizon. Chunks keep
+	/// their collision boxes as data. Set by SetUWorldTarget on a dedicated server
+	UFUNCTION(BlueprintCallable, Category="World")
+	bool IsDataOnly() const { return bDataOnlyMode; }
+	/// Log the resident chunks per ticket level, their memory and the render objects
+	UFUNCTION(BlueprintCallable, Category="World")
+	void LogWorldStats() const;
 
 	/// Query
+	/// The static conversions work on absolute world positions (block coordinates * BlockWorldSize), integer only
+	/// past the world -> block step. Member queries take positions in the current, possibly rebased, UWorld frame
 	UFUNCTION(BlueprintCallable, Category="Query")
 	static FIntVector WorldPosToChunkCoords(const FVector& WorldPos);
 	UFUNCTION(BlueprintCallable, Category="Query")
@@ -57,9 +89,70 @@ public:
 	UFUNCTION(BlueprintCallable, Category="Query")
 	static FIntVector BlockPosToChunkLocalCoords(const FIntVector& BlockPos);
 	UFUNCTION(BlueprintCallable, Category="Query")
+	FVector ToAbsoluteWorldPos(const FVector& WorldPos) const;
+	UFUNCTION(BlueprintCallable, Category="Query")
+	FVector ToRebasedWorldPos(const FVector& AbsoluteWorldPos) const;
+	UFUNCTION(BlueprintCallable, Category="Query")
 	UBlockDefinition* GetBlockAtWorldPos(const FVector& WorldPos);
 	UFUNCTION(BlueprintCallable, Category="Query")
 	UBlockDefinition* GetBlockAtBlockPos(const FIntVector& BlockPos);
+	/// Z of the first free block above the topmost opaque block of a column, read from the chunk height map.
+	/// INDEX_NONE if the chunk is not loaded
+	UFUNCTION(BlueprintCallable, Category="Query")
+	int32 GetSurfaceHeightAtBlockPos(int32 BlockX, int32 BlockY) const;
+	/// Spawn placement: standing position on the surface of the column under WorldPos, centered on the block
+	UFUNCTION(BlueprintCallable, Category="Query")
+	bool GetSurfaceAtWorldPos(const FVector& WorldPos, FVector& OutSurfacePos) const;
+	/// Batched block lookups for area scans, one lock for the whole batch and one map lookup per chunk.
+	/// Fill global block IDs (UBlockDefinition::BlockID), 0 is air and INDEX_NONE a block whose chunk is not loaded
+	UFUNCTION(BlueprintCallable, Category="Query")
+	void GetBlockIDsAtBlockPositions(const TArray<FIntVector>& BlockPositions, TArray<int32>& OutBlockIDs) const;
+	UFUNCTION(BlueprintCallable, Category="Query")
+	void GetBlockIDsInBox(const FIntVector& MinBlockPos, const FIntVector& MaxBlockPos, TArray<int32>& OutBlockIDs) const; // Inclusive, X first then Y then Z. Empty past 2^24 voxels
+	/// Same walk for the voxel light, Sky << 4 | Block (0 to 15 each). Full sky where the chunk is not loaded or not lit yet
+	UFUNCTION(BlueprintCallable, Category="Query")
+	void GetLightInBox(const FIntVector& MinBlockPos, const FIntVector& MaxBlockPos, TArray<uint8>& OutLight) const;
+	/// False while the chunk is drawn or about to be drawn as a reduced mesh (FChunkLod), its border
+	/// does not match its blocks then and the mesher keeps the faces against it. True if it is not loaded
+	bool IsChunkMeshedAtFullDetail(const FIntVector& ChunkCoords) const;
+	/// Mesh sections (one draw each) of a loaded chunk, INDEX_NONE if it is not loaded or being rebuilt
+	UFUNCTION(BlueprintCallable, Category="Query")
+	int32 GetChunkSectionCount(const FIntVector& ChunkCoords) const;
+	/// Voxel-native queries, walk the loaded block data instead of the physics scene. Positions are in the
+	/// rebased engine space, game thread only since RebaseOriginIfNeeded moves the origin they are read against
+	UFUNCTION(BlueprintCallable, Category="Query")
+	bool RaycastBlocks(const FVector& Start, const FVector& Direction, float MaxDistance, FVoxelRaycastHit& OutHit) const;
+	UFUNCTION(BlueprintCallable, Category="Query")
+	FVector SweepBlocks(const FBox& Box, const FVector& Delta) const; // Return the movement clipped against block collision
+	UFUNCTION(BlueprintCallable, Category="Query")
+	bool OverlapBlocks(const FBox& Box) const;
+	/// Same queries in absolute world space (ToAbsoluteWorldPos), they never read the engine origin. Safe to call from any thread
+	bool    RaycastBlocksAbsolute(const FVector& Start, const FVector& Direction, float MaxDistance, FVoxelRaycastHit& OutHit) const;
+	FVector SweepBlocksAbsolute(const FBox& Box, const FVector& Delta) const;
+	bool    OverlapBlocksAbsolute(const FBox& Box) const;
+
+	/// Edit
+	/// Queue a block change, applied by the next world tick once no worker reads the chunk, then relit
+	/// and remeshed. Game thread only, false if the chunk is not loaded. nullptr places air
+	UFUNCTION(BlueprintCallable, Category="Edit")
+	bool SetBlockAtBlockPos(const FIntVector& BlockPos, UBlockDefinition* Definition);
+
+	/// Simulation
+	/// Run the block OnScheduledTick DelayTicks world ticks from now (at least one). Ticks due
+	/// on the same world tick run in the order they were scheduled. False if the chunk is not loaded
+	UFUNCTION(BlueprintCallable, Category="Simulation")
+	bool ScheduleBlockTick(const FIntVector& BlockPos, int32 DelayTicks = 1);
+
+	/// Network
+	/// A client world receives its chunks from the server (UChunkStreamComponent) instead of generating them
+	bool  IsNetClient() const;
+	int32 GetTicketRadius() const; // Chunks around a player that hold a ticket, rendered or not
+	void  RegisterChunkStream(UChunkStreamComponent* Stream);
+	void  UnregisterChunkStream(UChunkStreamComponent* Stream);
+	/// Server, full packet of a resident chunk whose blocks are generated
+	bool EncodeChunkPacket(const FIntVector& ChunkCoords, TArray<uint8>& OutPacket) const;
+	/// Client, queue a full or delta packet, applied by the next world tick in arrival order
+	void ReceiveChunkPacket(const TArray<uint8>& Packet);
 
 	/// Notify
 	void NotifyNeighborsChunkLoaded(FIntVector ChunkCoords);
@@ -68,9 +161,17 @@ public:
 	bool AddEntity(APawn* InEntity);
 	UFUNCTION(BlueprintCallable, Category="Entity Management")
 	bool RemoveEntity(APawn* InEntity);
+	/// Keep the chunk and the ones within ForcedTicketRadius simulated without any player near, never rendered
+	UFUNCTION(BlueprintCallable, Category="Entity Management")
+	bool AddForcedChunk(const FIntVector& ChunkCoords);
+	UFUNCTION(BlueprintCallable, Category="Entity Management")
+	bool RemoveForcedChunk(const FIntVector& ChunkCoords);
 	/// Thread Pool Management
 	void InitializeChunkWorkerPool();
 	void ShutdownChunkWorkerPool();
+	/// Chunk Actor Pool Management
+	AChunkActor* AcquireChunkActor(const FIntVector& ChunkCoords);
+	void         ReleaseChunkActor(AChunkActor* ChunkActor);
 
 protected:
 	/// Properties
@@ -79,15 +180,100 @@ protected:
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="World Properties")
 	bool EnableWorldTick = true;
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="World Properties")
-	int32 ViewRadius = 3; // Player's field of view radius (blocks)
+	bool bDataOnlyMode = false; // Headless world (dedicated server), players tickets simulate instead of render
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="World Properties")
+	int32 ViewRadius = 3; // Player's field of view radius (chunks), rendered and simulated
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="World Properties")
+	int32 SimulationRingChunks = 2; // Chunks past the view radius of a player that are simulated but not rendered
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="World Properties")
+	int32 DataRingChunks = 1; // Chunks past every simulated area kept data-only, simulated edges read their blocks and light
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="World Properties")
+	int32 EntityTicketRadius = 1; // Chunks simulated around a registered entity (AddEntity) that no player controls
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="World Properties")
-	double GracePeriod = 10; // Uninstall grace period
+	int32 ForcedTicketRadius = 0; // Chunks simulated around a forced chunk (AddForcedChunk)
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="World Properties")
+	double GracePeriod = 10; // Grace period before an unticketed chunk release its actor, data stay until evicted
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="World Properties")
+	int32 ResidentMemoryBudgetMB = 256; // Resident chunk data and meshes, unticketed chunks are evicted LRU above it
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="World Properties")
+	int32 WarmCacheBudgetMB = 64; // Compressed evicted chunks kept for a cheap reload, 0 disable the warm tier
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="World Properties")
+	int32 MaxChunkUploadsPerTick = 8; // Ready chunks copied into actors per tick (mesh + collision), <= 0 no limit
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="World Properties")
+	int32 ChunkActorPoolBudget = 64; // Max hidden chunk actors kept for reuse, extra ones are destroyed
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="World Properties")
+	float OriginRebaseDistance = 500000.f; // Shift the engine world origin under the player past this distance, <= 0 disable
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="World Properties")
+	bool bEnableOcclusionCulling = true; // Hide loaded chunks the camera cannot see through open voxels (cave culling)
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="World Properties")
+	int32 LodDistance2x = 8; // Chunk distance to the closest player from which chunks are meshed at 2x blocks, <= 0 disable
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="World Properties")
+	int32 LodDistance4x = 16; // Same for 4x blocks, <= 0 disable
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="World Properties")
+	TObjectPtr<UMaterialInterface> TextureArrayMaterial = nullptr; // Mesh every chunk in one section, faces pick their layer (FBlockVariantDefinition::FaceTextureLayers)
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="World Properties")
+	int32 RegionMergeDistance = 8; // Chunks from this distance are merged in region clusters without chunk actor nor collision, <= 0 disable
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="World Properties")
+	int32 RegionClusterChunks = 4; // Edge of a region cluster in chunks
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="World Properties")
+	int32 HorizonRadius = 48; // Chunks, heightmap-only far terrain from ViewRadius up to this distance, <= ViewRadius disable
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="World Properties")
+	int32 HorizonTileChunks = 8; // Edge of a horizon tile in chunks
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="World Properties")
+	int32 HorizonCellBlocks = 8; // Blocks between two heightmap samples of a horizon tile
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="World Properties")
+	int32 RandomTicksPerChunk = 3; // Voxels sampled for a random block tick in every simulated chunk each world tick, 0 disable
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="World Properties")
+	int32 MaxDeltaBlockChanges = 512; // Blocks of a chunk changed in one tick above which clients get the whole chunk again instead of the changes
 
 private:
+	/// Block definition in a loaded chunk, nullptr for air, a missing chunk or data not generated yet. ChunksLock must be held
+	UBlockDefinition* FindBlockUnlocked(const FIntVector& BlockPos) const;
+	/// Chebyshev distance in chunks to the closest player chunk, MAX_int32 without player
+	int32 GetChunkDistanceToPlayers(const FIntVector& ChunkCoords) const;
+	/// FChunkLod level of a chunk at the given distance from the closest player
+	uint8 GetLodLevelForDistance(int32 ChunkDistance) const;
+	FIntVector GetRegionCoords(const FIntVector& ChunkCoords) const;
+	/// Move the chunk between its own actor and its region cluster, the mesh is uploaded again if it is idle
+	void SetChunkInRegion(FChunkHolder& H, bool bInRegion);
+	/// Drop the render of a chunk leaving the view, its actor or its part of the region cluster
+	void ReleaseChunkRender(FChunkHolder& H);
+	/// Write a block of an idle chunk, queue its relight and remesh the chunk and the neighbours that see it. ChunksLock write
+	void SetBlockUnlocked(FChunkHolder& H, const FIntVector& LocalCoords, UBlockDefinition* Definition);
+	/// Give the chunks around Center the levels of the ticket type rings, keep the strongest level of every chunk
+	void AddTicketSource(const FIntVector& Center, ETicketType Type, TMap<FIntVector, EChunkTicketLevel>& Out) const;
+
 	/// Thread Pool and Workers
 	UPROPERTY()
-	TObjectPtr<UChunkWorkerPool>               ChunkWorkerPool = nullptr;
-	TSet<FIntVector>                           PrevVisibleSet;
-	TMap<FIntVector, TUniquePtr<FChunkHolder>> Chunks;
-	FCriticalSection                           ChunksMutex;
+	TObjectPtr<UChunkWorkerPool>                      ChunkWorkerPool = nullptr;
+	/// Chunk Actor Pool, parked hidden actors waiting for the next load
+	UPROPERTY()
+	TArray<TObjectPtr<AChunkActor>>                   ChunkActorPool;
+	/// Far horizon, one actor for every tile
+	UPROPERTY()
+	TObjectPtr<AHorizonActor>                         HorizonActor = nullptr;
+	TMap<FIntVector, TSharedPtr<FHorizonTile>>        HorizonTiles; // Shared with the worker building the tile
+	/// Region clusters of distant chunks
+	UPROPERTY()
+	TMap<FIntVector, TObjectPtr<ARegionActor>>        RegionActors;
+	TMap<FIntVector, TSharedPtr<const FRegionMember>> RegionMembers; // Keyed by chunk, mesh copied at upload
+	TMap<FIntVector, TSharedPtr<FRegionMesh>>         RegionMerges; // Keyed by region, merge running on a worker
+	TSet<FIntVector>                                  DirtyRegions; // A member joined, left or changed
+	TMap<FIntVector, EChunkTicketLevel>               PrevTicketLevels; // Ticketed chunks of the last tick
+	TSet<FIntVector>                                  ForcedChunks;
+	TArray<TWeakObjectPtr<UChunkStreamComponent>>     ChunkStreams; // Player controllers streaming this world
+	TMap<FIntVector, TArray<FChunkBlockChange>>       NetBlockChanges; // Server, blocks changed this tick per chunk, in edit order
+	TArray<TArray<uint8>>                             ReceivedChunkPackets; // Client, waiting for their chunk to be idle
+	TArray<FIntVector>                                DroppedChunks; // Client, chunks the server must send again
+	TArray<FIntVector>                                PlayerChunkCenters; // Chunk of every player this tick, filled with the ticket levels
+	TMap<FIntVector, FChunkHolder*>                   Chunks; // Owned by ChunkHolderPool
+	TArray<TPair<FIntVector, UBlockDefinition*>>      PendingBlockEdits; // Block position and new block, in call order
+	std::atomic<int32>                                RunningLightStages{0}; // The next light phase waits for every stage, edits, packets and eviction only for the holders of one (LightStageCount)
+	int32                                             LightPhase       = 0; // (X mod 3) + (Y mod 3) * 3 of the chunks lit last
+	int64                                             BlockTickCount   = 0; // World ticks simulated so far
+	uint64                                            NextTickSequence = 0; // Order of the scheduled block ticks
+	FChunkHolderPool                                  ChunkHolderPool;
+	SIZE_T                                            ResidentBytes = 0;
+	FChunkWarmCache                                   WarmCache;
+	mutable FRWLock                                   ChunksLock; // Write: map and holder lifetime changes, Read: lookups and queries
 };
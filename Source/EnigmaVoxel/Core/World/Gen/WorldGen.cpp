@@ -1,47 +1,440 @@
 ﻿#include "WorldGen.hpp"
 
+#include "EnigmaVoxel/Core/Register/EnigmaRegistrationSubsystem.h"
+#include "EnigmaVoxel/Core/World/EnigmaWorld.h"
+#include "EnigmaVoxel/Core/World/VoxelCoords.h"
 #include "EnigmaVoxel/Modules/Block/Block.h"
+#include "EnigmaVoxel/Modules/Block/Enum/BlockDirection.h"
+#include "EnigmaVoxel/Modules/Chunk/ChunkCollision.h"
 #include "EnigmaVoxel/Modules/Chunk/ChunkHolder.h"
+#include "EnigmaVoxel/Modules/Chunk/ChunkLight.h"
+#include "EnigmaVoxel/Modules/Chunk/ChunkLod.h"
+#include "EnigmaVoxel/Modules/Chunk/ChunkWarmCache.h"
 
-void FWorldGen::GenerateFullChunk(UEnigmaWorld* World, FChunkHolder& H)
+namespace
 {
-	H.RefreshMaterialCache();
-	H.FillChunkWithArea(FIntVector(16, 16, 8), "Enigma", "Blue Enigma Block");
-	UE::Geometry::FDynamicMesh3 Tmp;
-	for (int z = 0; z < H.Dimension.Z; ++z)
+	const TCHAR* SurfaceBlockNamespace = TEXT("Enigma");
+	const TCHAR* SurfaceBlockPath      = TEXT("Blue Enigma Block");
+
+	const EBlockDirection MeshDirections[6] = {
+		EBlockDirection::EAST, EBlockDirection::WEST,
+		EBlockDirection::UP, EBlockDirection::DOWN,
+		EBlockDirection::SOUTH, EBlockDirection::NORTH
+	};
+
+	/// Solid blocks and light of a chunk with a one block border taken from the neighbour chunks,
+	/// the face culling, the AO and the face light never look the world up block by block
+	template <typename TLayout>
+	struct TPaddedChunk
 	{
-		for (int y = 0; y < H.Dimension.Y; ++y)
+		static constexpr int32 SizeX = TLayout::SizeX + 2;
+		static constexpr int32 SizeY = TLayout::SizeY + 2;
+		static constexpr int32 SizeZ = TLayout::SizeZ + 2;
+
+		TBitArray<>   Solid;
+		TArray<uint8> Light; // FChunkLight::GetPackedLight, full sky where nothing is known
+
+		static int32 ToIndex(const FIntVector& P)
+		{
+			return (P.X + 1) + ((P.Y + 1) + (P.Z + 1) * SizeY) * SizeX;
+		}
+
+		/// Local chunk coordinates, -1 and Size are the neighbour border
+		bool IsSolid(const FIntVector& P) const
+		{
+			return Solid[ToIndex(P)];
+		}
+
+		void Set(const FIntVector& P, bool bSolid)
+		{
+			Solid[ToIndex(P)] = bSolid;
+		}
+
+		/// Brightest of the sky and block light, 0 to 15
+		uint8 GetLightLevel(const FIntVector& P) const
 		{
-			for (int x = 0; x < H.Dimension.X; ++x)
+			const uint8 Packed = Light[ToIndex(P)];
+			return FMath::Max<uint8>(Packed >> 4, Packed & 0xF);
+		}
+
+		void Fill(UEnigmaWorld* World, const FChunkHolder& H)
+		{
+			Solid.Init(false, SizeX * SizeY * SizeZ);
+			Light.Init(FChunkLight::MaxLevel << 4, SizeX * SizeY * SizeZ);
+			for (int32 z = 0; z < TLayout::SizeZ; ++z)
 			{
-				const FBlock& B = H.GetBlock({x, y, z});
-				if (!B.Definition)
+				for (int32 y = 0; y < TLayout::SizeY; ++y)
 				{
-					continue;
+					for (int32 x = 0; x < TLayout::SizeX; ++x)
+					{
+						const int32 Index = TLayout::Index(x, y, z);
+						Set(FIntVector(x, y, z), H.GetBlockIDAt(Index) != 0);
+						Light[ToIndex(FIntVector(x, y, z))] = FChunkLight::GetPackedLight(H, Index);
+					}
+				}
+			}
+			if (!World)
+			{
+				return;
+			}
+			// The four side slabs, corners included, one locked batch each. Above and below the chunk is outside the world
+			constexpr int32 X = TLayout::SizeX;
+			constexpr int32 Y = TLayout::SizeY;
+			constexpr int32 Z = TLayout::SizeZ;
+			FillSlab(World, H.Coords, FIntVector(-1, -1, 0), FIntVector(X, -1, Z - 1));
+			FillSlab(World, H.Coords, FIntVector(-1, Y, 0), FIntVector(X, Y, Z - 1));
+			FillSlab(World, H.Coords, FIntVector(-1, 0, 0), FIntVector(-1, Y - 1, Z - 1));
+			FillSlab(World, H.Coords, FIntVector(X, 0, 0), FIntVector(X, Y - 1, Z - 1));
+
+			// A neighbour drawn as a reduced mesh rounds its border up or down, keep the faces
+			// against it so a cell rounded down leaves no hole through the terrain
+			for (int32 dy = -1; dy <= 1; ++dy)
+			{
+				for (int32 dx = -1; dx <= 1; ++dx)
+				{
+					if ((dx == 0 && dy == 0) || World->IsChunkMeshedAtFullDetail(H.Coords + FIntVector(dx, dy, 0)))
+					{
+						continue;
+					}
+					const int32 MinX = dx < 0 ? -1 : dx * X;
+					const int32 MaxX = dx == 0 ? X - 1 : MinX;
+					const int32 MinY = dy < 0 ? -1 : dy * Y;
+					const int32 MaxY = dy == 0 ? Y - 1 : MinY;
+					for (int32 z = 0; z < Z; ++z)
+					{
+						for (int32 y = MinY; y <= MaxY; ++y)
+						{
+							for (int32 x = MinX; x <= MaxX; ++x)
+							{
+								Set(FIntVector(x, y, z), false);
+							}
+						}
+					}
 				}
-				AppendBoxForBlock(Tmp, B, H);
 			}
 		}
+
+		void FillSlab(UEnigmaWorld* World, const FIntVector& ChunkCoords, const FIntVector& Min, const FIntVector& Max)
+		{
+			const FIntVector Origin = FVoxelCoords::ChunkToBlock(ChunkCoords);
+			TArray<int32>    BlockIDs;
+			TArray<uint8>    SlabLight;
+			World->GetBlockIDsInBox(Origin + Min, Origin + Max, BlockIDs);
+			World->GetLightInBox(Origin + Min, Origin + Max, SlabLight);
+
+			const FIntVector Size = Max - Min + FIntVector(1);
+			for (int32 z = 0; z < Size.Z; ++z)
+			{
+				for (int32 y = 0; y < Size.Y; ++y)
+				{
+					for (int32 x = 0; x < Size.X; ++x)
+					{
+						// INDEX_NONE (not loaded) and 0 (air) leave the face visible
+						const int32 Index = x + (y + z * Size.Y) * Size.X;
+						Set(Min + FIntVector(x, y, z), BlockIDs[Index] > 0);
+						Light[ToIndex(Min + FIntVector(x, y, z))] = SlabLight[Index];
+					}
+				}
+			}
+		}
+
+		/// Classic 3 neighbour voxel AO of the face corners: the two side blocks and the
+		/// diagonal one in the layer the face looks at, 0 fully occluded to 3 open
+		void ComputeFaceAO(const FIntVector& P, EBlockDirection Direction, uint8 OutAO[4]) const
+		{
+			const FIntVector Normal = GetFaceNormal(Direction);
+			const FIntVector Layer  = P + Normal;
+			const int32      N      = Normal.X != 0 ? 0 : (Normal.Y != 0 ? 1 : 2);
+			const int32      A      = (N + 1) % 3;
+			const int32      B      = (N + 2) % 3;
+			for (int32 i = 0; i < 4; ++i)
+			{
+				const FIntVector Corner = GetFaceCorner(Direction, i);
+				FIntVector       StepA(0), StepB(0);
+				StepA[A] = Corner[A] ? 1 : -1;
+				StepB[B] = Corner[B] ? 1 : -1;
+
+				const bool bSideA  = IsSolid(Layer + StepA);
+				const bool bSideB  = IsSolid(Layer + StepB);
+				const bool bCorner = IsSolid(Layer + StepA + StepB);
+				OutAO[i]           = bSideA && bSideB ? 0 : 3 - (bSideA + bSideB + bCorner);
+			}
+		}
+	};
+
+	/// Section and texture layer of the 6 faces of a block
+	struct FBlockFaceSections
+	{
+		bool  bValid = false;
+		int32 Section[6];
+		int32 Layer[6];
+
+		void Resolve(FChunkHolder& H, const FBlock& Block)
+		{
+			bValid = Block.Definition != nullptr;
+			for (const EBlockDirection Direction : MeshDirections)
+			{
+				const uint8 Face = static_cast<uint8>(Direction);
+				Section[Face]    = bValid ? H.GetFaceSection(Block, Direction, Layer[Face]) : INDEX_NONE;
+			}
+		}
+	};
+
+	/// Faces merge when the key is equal: section (16 bits), texture layer (16 bits), light level (4 bits)
+	/// and 2 bits of AO per corner. The top bit marks a face so no key is 0
+	uint64 MakeFaceKey(int32 Section, int32 Layer, uint8 Light, const uint8 CornerAO[4])
+	{
+		return 1ull << 63
+			| static_cast<uint64>(static_cast<uint16>(Section)) << 32
+			| static_cast<uint64>(static_cast<uint16>(Layer)) << 16
+			| static_cast<uint64>(Light & 0xF) << 8
+			| CornerAO[0] | CornerAO[1] << 2 | CornerAO[2] << 4 | CornerAO[3] << 6;
+	}
+
+	void BreakFaceKey(uint64 Key, int32& OutSection, int32& OutLayer, uint8& OutLight, uint8 OutAO[4])
+	{
+		OutSection = static_cast<int16>(Key >> 32);
+		OutLayer   = static_cast<int16>(Key >> 16);
+		OutLight   = (Key >> 8) & 0xF;
+		for (int32 i = 0; i < 4; ++i)
+		{
+			OutAO[i] = (Key >> (i * 2)) & 3;
+		}
 	}
-	H.Mesh = CopyTemp(Tmp);
+}
+
+void FWorldGen::GenerateFullChunk(UEnigmaWorld* World, FChunkHolder& H, bool bBuildMesh)
+{
+	// Flat terrain, one height for the whole chunk
+	const FInt64Vector Origin = FVoxelCoords::ChunkToBlock64(H.Coords);
+	H.FillChunkWithArea(FIntVector(FChunkLayout::SizeX, FChunkLayout::SizeY, SampleHeight(Origin.X, Origin.Y)), SurfaceBlockNamespace, SurfaceBlockPath);
+	H.TryCompactUniform();
+	if (bBuildMesh)
+	{
+		BuildLocalMesh(H);
+	}
+}
+
+int32 FWorldGen::SampleHeight(int64 BlockX, int64 BlockY)
+{
+	return FChunkLayout::SizeZ / 2;
+}
+
+UBlockDefinition* FWorldGen::SampleSurfaceBlock(int64 BlockX, int64 BlockY)
+{
+	return UEnigmaRegistrationSubsystem::BLOCK_GET_VALUE(SurfaceBlockNamespace, SurfaceBlockPath);
+}
+
+/// Restore the blocks from the warm cache entry, much cheaper than generating,
+/// fall back to the generator if the entry cannot be decompressed
+void FWorldGen::RestoreChunk(UEnigmaWorld* World, FChunkHolder& H, bool bBuildMesh)
+{
+	TSharedPtr<FCompressedChunk> Warm = MoveTemp(H.WarmData);
+	if (!Warm.IsValid() || !FChunkWarmCache::Decompress(*Warm, H))
+	{
+		GenerateFullChunk(World, H, bBuildMesh);
+		return;
+	}
+	if (bBuildMesh)
+	{
+		BuildLocalMesh(H);
+	}
+}
+
+/// Mesh the chunk with its own blocks only, the chunk border is culled
+/// later by RebuildMesh once the neighbours are loaded
+void FWorldGen::BuildLocalMesh(FChunkHolder& H)
+{
+	H.RefreshMaterialCache();
+	UE::Geometry::FDynamicMesh3 Tmp;
+	if (BuildLodMesh(H, Tmp))
+	{
+		return;
+	}
+	MeshBlocks<FChunkLayout>(nullptr, H, Tmp);
+	H.Mesh = MoveTemp(Tmp);
+	BuildCollision(H);
 }
 
 void FWorldGen::RebuildMesh(UEnigmaWorld* World, FChunkHolder& H)
 {
-	H.Mesh = UE::Geometry::FDynamicMesh3();
 	UE::Geometry::FDynamicMesh3 Tmp;
 	H.RefreshMaterialCache();
-	for (int z = 0; z < H.Dimension.Z; ++z)
+	if (BuildLodMesh(H, Tmp))
+	{
+		return;
+	}
+	MeshBlocks<FChunkLayout>(World, H, Tmp);
+	H.Mesh = MoveTemp(Tmp);
+	BuildCollision(H);
+}
+
+void FWorldGen::RebuildCollision(FChunkHolder& H)
+{
+	TArray<FBox> Boxes;
+	FChunkCollision::BuildBoxes(H, Boxes);
+	H.CollisionBoxes = MoveTemp(Boxes);
+}
+
+/// Distant chunk: reduced mesh with border skirts, it does not depend on the neighbours
+/// @return false if the chunk is meshed at full detail, Mesh is left to the caller
+bool FWorldGen::BuildLodMesh(FChunkHolder& H, UE::Geometry::FDynamicMesh3& Mesh)
+{
+	const uint8 LodLevel = H.LodLevel.load(std::memory_order_relaxed);
+	H.MeshLodLevel       = LodLevel;
+	if (LodLevel == 0)
+	{
+		return false;
+	}
+	FChunkLod::BuildMesh(H, LodLevel, Mesh);
+	H.Mesh = MoveTemp(Mesh);
+	BuildCollision(H);
+	return true;
+}
+
+/// Emit the visible faces of the chunk. Faces are culled and shaded against a padded grid
+/// (the chunk plus one block of its neighbours, air and full sky when World is nullptr or the
+/// neighbour is not loaded), then merged per slice into rectangles of faces sharing the
+/// section, the texture layer, the light in front and the 4 corner AO values so the shading
+/// stays exact. A uniform solid chunk only visits its outer slices, its inner faces are culled.
+/// The loop bounds and the voxel index come from the layout so they are constants
+template <typename TLayout>
+void FWorldGen::MeshBlocks(UEnigmaWorld* World, FChunkHolder& H, UE::Geometry::FDynamicMesh3& Mesh)
+{
+	check(H.IsUniform() || H.Blocks.Num() == TLayout::Count);
+	if (H.IsEmpty())
+	{
+		return;
+	}
+
+	TPaddedChunk<TLayout> Padded;
+	Padded.Fill(World, H);
+
+	// Face sections of every block ID, blocks with extra data may use another state and resolve their own
+	TMap<uint16, FBlockFaceSections> SectionCache;
+	auto GetFaceSections = [&H, &SectionCache](const FIntVector& LocalCoords, uint16 BlockID, FBlockFaceSections& Out)
 	{
-		for (int y = 0; y < H.Dimension.Y; ++y)
+		if (H.ExtraData.Num() > 0 && H.FindExtraData(LocalCoords))
 		{
-			for (int x = 0; x < H.Dimension.X; ++x)
+			Out.Resolve(H, H.GetBlock(LocalCoords));
+			return;
+		}
+		if (const FBlockFaceSections* Found = SectionCache.Find(BlockID))
+		{
+			Out = *Found;
+			return;
+		}
+		Out.Resolve(H, FBlock(LocalCoords, FChunkHolder::ResolveBlockID(BlockID)));
+		SectionCache.Add(BlockID, Out);
+	};
+
+	const FIntVector Dim = TLayout::GetDimension();
+	TArray<uint64>   Mask;
+	for (const EBlockDirection Direction : MeshDirections)
+	{
+		const uint8      Face   = static_cast<uint8>(Direction);
+		const FIntVector Normal = GetFaceNormal(Direction);
+		const int32      N      = Normal.X != 0 ? 0 : (Normal.Y != 0 ? 1 : 2);
+		const int32      A      = (N + 1) % 3;
+		const int32      B      = (N + 2) % 3;
+		Mask.SetNumUninitialized(Dim[A] * Dim[B], EAllowShrinking::No);
+
+		const int32 FirstSlice = H.IsUniform() && Normal[N] > 0 ? Dim[N] - 1 : 0;
+		const int32 EndSlice   = H.IsUniform() && Normal[N] < 0 ? 1 : Dim[N];
+		for (int32 n = FirstSlice; n < EndSlice; ++n)
+		{
+			// Visible faces of the slice, 0 where there is none
+			FBlockFaceSections Sections;
+			for (int32 b = 0; b < Dim[B]; ++b)
 			{
-				const FBlock& B = H.GetBlock({x, y, z});
-				if (!B.Definition) { continue; }
-				AppendBoxForBlock(World, Tmp, B, H);
+				for (int32 a = 0; a < Dim[A]; ++a)
+				{
+					FIntVector P;
+					P[N] = n;
+					P[A] = a;
+					P[B] = b;
+
+					uint64&      Key     = Mask[a + b * Dim[A]];
+					const uint16 BlockID = H.GetBlockIDAt(TLayout::Index(P));
+					Key                  = 0;
+					if (BlockID == 0 || Padded.IsSolid(P + Normal))
+					{
+						continue;
+					}
+					GetFaceSections(P, BlockID, Sections);
+					if (!Sections.bValid)
+					{
+						continue;
+					}
+					uint8 CornerAO[4];
+					Padded.ComputeFaceAO(P, Direction, CornerAO);
+					Key = MakeFaceKey(Sections.Section[Face], Sections.Layer[Face], Padded.GetLightLevel(P + Normal), CornerAO);
+				}
+			}
+
+			// Greedy: grow each face along A, then the whole row along B
+			for (int32 b = 0; b < Dim[B]; ++b)
+			{
+				for (int32 a = 0; a < Dim[A];)
+				{
+					const uint64 Key = Mask[a + b * Dim[A]];
+					if (Key == 0)
+					{
+						++a;
+						continue;
+					}
+
+					int32 Width = 1;
+					while (a + Width < Dim[A] && Mask[a + Width + b * Dim[A]] == Key)
+					{
+						++Width;
+					}
+					int32 Height = 1;
+					for (; b + Height < Dim[B]; ++Height)
+					{
+						bool bRowMatches = true;
+						for (int32 i = 0; i < Width && bRowMatches; ++i)
+						{
+							bRowMatches = Mask[a + i + (b + Height) * Dim[A]] == Key;
+						}
+						if (!bRowMatches)
+						{
+							break;
+						}
+					}
+					for (int32 h = 0; h < Height; ++h)
+					{
+						FMemory::Memzero(&Mask[a + (b + h) * Dim[A]], Width * sizeof(uint64));
+					}
+
+					FIntVector Origin, Extent;
+					Origin[N] = n;
+					Origin[A] = a;
+					Origin[B] = b;
+					Extent[N] = 1;
+					Extent[A] = Width;
+					Extent[B] = Height;
+
+					int32 SectionID, TextureLayer;
+					uint8 Light;
+					uint8 CornerAO[4];
+					BreakFaceKey(Key, SectionID, TextureLayer, Light, CornerAO);
+					AppendQuadForFace(Mesh, Origin, Extent, Direction, SectionID, H.BlockSize, TextureLayer, CornerAO, Light);
+					a += Width;
+				}
 			}
 		}
 	}
-	H.Mesh = CopyTemp(Tmp);
+}
+
+/// Greedy box collision of the chunk, built next to the mesh so the game thread
+/// only has to upload the boxes
+void FWorldGen::BuildCollision(FChunkHolder& H)
+{
+	TArray<FBox> Boxes;
+	FChunkCollision::BuildBoxes(H, Boxes);
+	H.CollisionBoxes = MoveTemp(Boxes);
+
+	// Same pass over the final blocks, the face connectivity feeds the world visibility walk
+	H.FaceConnections = FChunkVisibility::ComputeConnections(H);
 }
@@ -1,10 +1,29 @@
 ﻿#pragma once
 
 class UEnigmaWorld;
+class UBlockDefinition;
 struct FChunkHolder;
+namespace UE::Geometry
+{
+	class FDynamicMesh3;
+}
 
 struct FWorldGen
 {
-	static void GenerateFullChunk(UEnigmaWorld* World, FChunkHolder& H);
+	/// Fill the blocks, then build the local mesh unless bBuildMesh is false (chunk not rendered)
+	static void GenerateFullChunk(UEnigmaWorld* World, FChunkHolder& H, bool bBuildMesh = true);
+	static void RestoreChunk(UEnigmaWorld* World, FChunkHolder& H, bool bBuildMesh = true);
 	static void RebuildMesh(UEnigmaWorld* World, FChunkHolder& H);
+	static void RebuildCollision(FChunkHolder& H); // Collision boxes only, data-only worlds have no mesh nor visibility
+
+	/// Terrain 2D heightmap, shared by the chunk generator and the far horizon so both agree
+	static int32             SampleHeight(int64 BlockX, int64 BlockY); // Solid blocks in the column
+	static UBlockDefinition* SampleSurfaceBlock(int64 BlockX, int64 BlockY);
+
+private:
+	static void BuildLocalMesh(FChunkHolder& H);
+	static bool BuildLodMesh(FChunkHolder& H, UE::Geometry::FDynamicMesh3& Mesh);
+	template <typename TLayout>
+	static void MeshBlocks(UEnigmaWorld* World, FChunkHolder& H, UE::Geometry::FDynamicMesh3& Mesh);
+	static void BuildCollision(FChunkHolder& H);
 };
@@ -0,0 +1,236 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "VoxelQuery.h"
+#include "EnigmaVoxel/Modules/Block/BlockDefinition.h"
+
+namespace
+{
+	/// Cells touched by the box, the max bound is exclusive so a box resting on a face does not reach the next cell
+	void GetCellRange(const FBox& Box, double BlockSize, FIntVector& OutMin, FIntVector& OutMax)
+	{
+		constexpr double Epsilon = 1e-4;
+		OutMin = FIntVector(
+			FMath::FloorToInt(Box.Min.X / BlockSize),
+			FMath::FloorToInt(Box.Min.Y / BlockSize),
+			FMath::FloorToInt(Box.Min.Z / BlockSize));
+		OutMax = FIntVector(
+			FMath::FloorToInt((Box.Max.X - Epsilon) / BlockSize),
+			FMath::FloorToInt((Box.Max.Y - Epsilon) / BlockSize),
+			FMath::FloorToInt((Box.Max.Z - Epsilon) / BlockSize));
+	}
+
+	bool OverlapsOnAxis(const FBox& A, const FBox& B, int32 Axis)
+	{
+		return A.Min[Axis] < B.Max[Axis] && A.Max[Axis] > B.Min[Axis];
+	}
+
+	/// Direction whose face the ray enters through when it crosses a cell boundary along Axis
+	EBlockDirection GetEnteredFace(int32 Axis, int32 Step)
+	{
+		switch (Axis)
+		{
+		case 0:
+			return Step > 0 ? EBlockDirection::SOUTH : EBlockDirection::NORTH;
+		case 1:
+			return Step > 0 ? EBlockDirection::WEST : EBlockDirection::EAST;
+		default:
+			return Step > 0 ? EBlockDirection::DOWN : EBlockDirection::UP;
+		}
+	}
+}
+
+bool FVoxelQuery::GetBlockCollisionBox(const UBlockDefinition* Definition, const FIntVector& BlockPos, double BlockSize, FBox& OutBox)
+{
+	if (!Definition)
+	{
+		return false;
+	}
+
+	const FVector Min = FVector(BlockPos) * BlockSize;
+	double        Top = BlockSize;
+	if (Definition->CollisionType == ECollisionType::UNIT_BLOCK_HALF)
+	{
+		Top = BlockSize * 0.5;
+	}
+	OutBox = FBox(Min, Min + FVector(BlockSize, BlockSize, Top));
+	return true;
+}
+
+bool FVoxelQuery::Raycast(const FVector& Start, const FVector& Direction, double MaxDistance, double BlockSize, FVoxelBlockLookup Lookup, FVoxelRaycastHit& OutHit)
+{
+	OutHit = FVoxelRaycastHit();
+
+	const FVector Dir = Direction.GetSafeNormal();
+	if (Dir.IsNearlyZero() || MaxDistance <= 0.0)
+	{
+		return false;
+	}
+
+	FIntVector Cell(
+		FMath::FloorToInt(Start.X / BlockSize),
+		FMath::FloorToInt(Start.Y / BlockSize),
+		FMath::FloorToInt(Start.Z / BlockSize));
+
+	// Per axis: step direction, distance along the ray to the next boundary and between two boundaries
+	int32  Step[3];
+	double TMax[3];
+	double TDelta[3];
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		if (FMath::IsNearlyZero(Dir[Axis]))
+		{
+			Step[Axis]   = 0;
+			TMax[Axis]   = TNumericLimits<double>::Max();
+			TDelta[Axis] = TNumericLimits<double>::Max();
+			continue;
+		}
+		Step[Axis] = Dir[Axis] > 0.0 ? 1 : -1;
+
+		const double Boundary = (Cell[Axis] + (Step[Axis] > 0 ? 1 : 0)) * BlockSize;
+		TMax[Axis]            = (Boundary - Start[Axis]) / Dir[Axis];
+		TDelta[Axis]          = BlockSize / FMath::Abs(Dir[Axis]);
+	}
+
+	double          T           = 0.0;
+	EBlockDirection EnteredFace = Dir.Z < 0.0 ? EBlockDirection::UP : EBlockDirection::DOWN;
+	while (T <= MaxDistance)
+	{
+		if (UBlockDefinition* Definition = Lookup(Cell))
+		{
+			FBox Box;
+			if (GetBlockCollisionBox(Definition, Cell, BlockSize, Box))
+			{
+				// Full cubes are hit at the cell boundary, partial shapes need the exact segment test
+				const double  CellExit = FMath::Min3(TMax[0], TMax[1], TMax[2]);
+				const FVector SegStart = Start + Dir * T;
+				const FVector SegEnd   = Start + Dir * FMath::Min(CellExit, MaxDistance);
+				FVector       HitLocation;
+				FVector       HitNormal;
+				float         HitTime;
+				const bool    bFullCell = Box.Max.Z - Box.Min.Z >= BlockSize;
+				if (bFullCell || FMath::LineExtentBoxIntersection(Box, SegStart, SegEnd, FVector::ZeroVector, HitLocation, HitNormal, HitTime))
+				{
+					OutHit.bHit       = true;
+					OutHit.BlockPos   = Cell;
+					OutHit.Definition = Definition;
+					if (bFullCell)
+					{
+						OutHit.Face     = EnteredFace;
+						OutHit.Location = SegStart;
+						OutHit.Distance = static_cast<float>(T);
+					}
+					else
+					{
+						OutHit.Face     = HitNormal.Z > 0.5 ? EBlockDirection::UP : EnteredFace;
+						OutHit.Location = HitLocation;
+						OutHit.Distance = static_cast<float>(FVector::Dist(Start, HitLocation));
+					}
+					return true;
+				}
+			}
+		}
+
+		// Advance to the closest boundary
+		int32 Axis = 0;
+		if (TMax[1] < TMax[Axis])
+		{
+			Axis = 1;
+		}
+		if (TMax[2] < TMax[Axis])
+		{
+			Axis = 2;
+		}
+		T           = TMax[Axis];
+		TMax[Axis] += TDelta[Axis];
+		Cell[Axis] += Step[Axis];
+		EnteredFace = GetEnteredFace(Axis, Step[Axis]);
+	}
+	return false;
+}
+
+bool FVoxelQuery::OverlapAABB(const FBox& Box, double BlockSize, FVoxelBlockLookup Lookup)
+{
+	FIntVector Min, Max;
+	GetCellRange(Box, BlockSize, Min, Max);
+
+	for (int32 z = Min.Z; z <= Max.Z; ++z)
+	{
+		for (int32 y = Min.Y; y <= Max.Y; ++y)
+		{
+			for (int32 x = Min.X; x <= Max.X; ++x)
+			{
+				const FIntVector Pos(x, y, z);
+				FBox             BlockBox;
+				if (GetBlockCollisionBox(Lookup(Pos), Pos, BlockSize, BlockBox)
+					&& OverlapsOnAxis(Box, BlockBox, 0) && OverlapsOnAxis(Box, BlockBox, 1) && OverlapsOnAxis(Box, BlockBox, 2))
+				{
+					return true;
+				}
+			}
+		}
+	}
+	return false;
+}
+
+FVector FVoxelQuery::SweepAABB(const FBox& Box, const FVector& Delta, double BlockSize, FVoxelBlockLookup Lookup)
+{
+	FBox    Moving = Box;
+	FVector Result = FVector::ZeroVector;
+
+	// Vertical first so walking on the ground is not blocked by the block under the feet
+	static constexpr int32 AxisOrder[3] = {2, 0, 1};
+	for (const int32 Axis : AxisOrder)
+	{
+		double Move = Delta[Axis];
+		if (FMath::IsNearlyZero(Move))
+		{
+			continue;
+		}
+
+		// Only the cells the box sweeps through along this axis
+		FBox Swept = Moving;
+		if (Move > 0.0)
+		{
+			Swept.Max[Axis] += Move;
+		}
+		else
+		{
+			Swept.Min[Axis] += Move;
+		}
+		FIntVector Min, Max;
+		GetCellRange(Swept, BlockSize, Min, Max);
+
+		const int32 Other0 = (Axis + 1) % 3;
+		const int32 Other1 = (Axis + 2) % 3;
+		for (int32 z = Min.Z; z <= Max.Z; ++z)
+		{
+			for (int32 y = Min.Y; y <= Max.Y; ++y)
+			{
+				for (int32 x = Min.X; x <= Max.X; ++x)
+				{
+					const FIntVector Pos(x, y, z);
+					FBox             BlockBox;
+					if (!GetBlockCollisionBox(Lookup(Pos), Pos, BlockSize, BlockBox)
+						|| !OverlapsOnAxis(Moving, BlockBox, Other0) || !OverlapsOnAxis(Moving, BlockBox, Other1))
+					{
+						continue;
+					}
+
+					if (Move > 0.0 && Moving.Max[Axis] <= BlockBox.Min[Axis])
+					{
+						Move = FMath::Min(Move, BlockBox.Min[Axis] - Moving.Max[Axis]);
+					}
+					else if (Move < 0.0 && Moving.Min[Axis] >= BlockBox.Max[Axis])
+					{
+						Move = FMath::Max(Move, BlockBox.Max[Axis] - Moving.Min[Axis]);
+					}
+				}
+			}
+		}
+
+		Moving.Min[Axis] += Move;
+		Moving.Max[Axis] += Move;
+		Result[Axis]      = Move;
+	}
+	return Result;
+}
@@ -0,0 +1,59 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "EnigmaVoxel/Modules/Block/Enum/BlockDirection.h"
+#include "VoxelQuery.generated.h"
+
+class UBlockDefinition;
+
+USTRUCT(BlueprintType)
+struct FVoxelRaycastHit
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category="Query")
+	bool bHit = false;
+
+	// Block integer position in the world
+	UPROPERTY(BlueprintReadOnly, Category="Query")
+	FIntVector BlockPos = FIntVector::ZeroValue;
+
+	// The face of the hit block the ray entered through
+	UPROPERTY(BlueprintReadOnly, Category="Query")
+	EBlockDirection Face = EBlockDirection::UP;
+
+	UPROPERTY(BlueprintReadOnly, Category="Query")
+	TObjectPtr<UBlockDefinition> Definition = nullptr;
+
+	UPROPERTY(BlueprintReadOnly, Category="Query")
+	FVector Location = FVector::ZeroVector;
+
+	UPROPERTY(BlueprintReadOnly, Category="Query")
+	float Distance = 0.f;
+};
+
+/// Resolve a block definition by its world block position, nullptr for air or when the chunk is not loaded
+using FVoxelBlockLookup = TFunctionRef<UBlockDefinition*(const FIntVector& BlockPos)>;
+
+/**
+ * Voxel-native queries that walk the block grid directly instead of tracing the chunk
+ * meshes through physics. The block lookup is provided by the caller (UEnigmaWorld holds
+ * its chunk read lock around the call) so the algorithms stay free of world state.
+ */
+struct FVoxelQuery
+{
+	/// Amanatides-Woo grid traversal, stop at the first non-air block
+	static bool Raycast(const FVector& Start, const FVector& Direction, double MaxDistance, double BlockSize, FVoxelBlockLookup Lookup, FVoxelRaycastHit& OutHit);
+
+	/// Whether the box intersects the collision of any loaded block
+	static bool OverlapAABB(const FBox& Box, double BlockSize, FVoxelBlockLookup Lookup);
+
+	/// Move the box by Delta and clip the movement against block collision, axis by axis (Z, X then Y)
+	/// @return The movement that can be applied without penetrating any block
+	static FVector SweepAABB(const FBox& Box, const FVector& Delta, double BlockSize, FVoxelBlockLookup Lookup);
+
+	/// Collision box of a block in world space, false for air
+	static bool GetBlockCollisionBox(const UBlockDefinition* Definition, const FIntVector& BlockPos, double BlockSize, FBox& OutBox);
+};
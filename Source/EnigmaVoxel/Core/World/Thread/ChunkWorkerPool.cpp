@@ -1,5 +1,6 @@
 ﻿#include "ChunkWorkerPool.h"
 #include "ChunkWorker.h"
+#include "EnigmaVoxel/Core/World/EnigmaWorld.h"
 #include "EnigmaVoxel/Core/World/Gen/WorldGen.hpp"
 #include "EnigmaVoxel/Modules/Chunk/ChunkHolder.h"
 
@@ -59,18 +60,46 @@ bool UChunkWorkerPool::EnqueueBuildTask(FChunkHolder* Holder, bool bMeshOnly, UE
 		NewJob->Key     = Key;
 		NewJob->Promise = MakeShared<TPromise<void>>();
 		Holder->bNeedsNeighborNotify.store(!bMeshOnly, std::memory_order_relaxed);
-		NewJob->Func = [Promise,Holder,bMeshOnly,World]()
+		NewJob->Func = [this,Key,Promise,Holder,bMeshOnly,World]()
 		{
+			// Simulated and data-only chunks are never drawn, the world meshes them once they are rendered.
+			// A data-only world still needs their collision, as boxes without actor
+			const bool bBuildMesh      = Holder->IsRendered();
+			const bool bBuildCollision = !bBuildMesh && World->IsDataOnly();
 			if (bMeshOnly)
 			{
-				FWorldGen::RebuildMesh(World, *Holder);
+				if (bBuildMesh)
+				{
+					FWorldGen::RebuildMesh(World, *Holder);
+				}
+			}
+			else if (Holder->WarmData.IsValid())
+			{
+				FWorldGen::RestoreChunk(World, *Holder, bBuildMesh);
+				Holder->bDataReady = true;
 			}
 			else
 			{
-				FWorldGen::GenerateFullChunk(World, *Holder);
+				FWorldGen::GenerateFullChunk(World, *Holder, bBuildMesh);
+				Holder->bDataReady = true;
+			}
+			if (bBuildCollision)
+			{
+				FWorldGen::RebuildCollision(*Holder);
+			}
+			Holder->bHasMesh = bBuildMesh;
+			// The chunk stays deduplicated until its holder is written, a new build of the same coords may start from here
+			{
+				FScopeLock _(&Mutex);
+				Running.Remove(Key);
+			}
+			// Publish the stage before resolving the future, the holder may be recycled once it is ready.
+			// A chunk that lost its ticket meanwhile stay PendingUnload, SetTicketLevel will bring it back.
+			EChunkStage Current = Holder->Stage.load();
+			while (Current != EChunkStage::PendingUnload && !Holder->Stage.compare_exchange_weak(Current, EChunkStage::Ready))
+			{
 			}
 			Promise->SetValue();
-			Holder->Stage = EChunkStage::Ready;
 		};
 		Running.Add(Key, NewJob);
 		Pending.Enqueue(NewJob);
@@ -79,6 +108,18 @@ bool UChunkWorkerPool::EnqueueBuildTask(FChunkHolder* Holder, bool bMeshOnly, UE
 	return true;
 }
 
+void UChunkWorkerPool::EnqueueTask(TFunction<void()> Func)
+{
+	FQueued* NewJob = new FQueued;
+	NewJob->Key     = FIntVector(MAX_int32);
+	NewJob->Func    = MoveTemp(Func);
+	{
+		FScopeLock _(&Mutex);
+		Pending.Enqueue(NewJob);
+	}
+	WakeAnyIdleWorker();
+}
+
 // Called By worker
 bool UChunkWorkerPool::DequeueJob(TUniqueFunction<void()>& Out)
 {
@@ -89,7 +130,6 @@ bool UChunkWorkerPool::DequeueJob(TUniqueFunction<void()>& Out)
 		{
 			return false;
 		}
-		Running.Remove(J->Key);
 	}
 
 	// Let FQueued end with the Job lifecycle
@@ -19,6 +19,7 @@ public:
 
 	// Task interface
 	bool EnqueueBuildTask(FChunkHolder* Holder, bool bMeshOnly, UEnigmaWorld* World = nullptr); // Called by external
+	void EnqueueTask(TFunction<void()> Func); // Job not bound to a chunk (horizon tiles...), not deduplicated
 	bool DequeueJob(TUniqueFunction<void()>& Out); // Called by worker
 
 private:
@@ -33,7 +34,7 @@ private:
 	// Data
 	TQueue<FQueued*>           Pending;
 	FCriticalSection           Mutex;
-	TMap<FIntVector, FQueued*> Running; // Remove duplicates
+	TMap<FIntVector, FQueued*> Running; // Remove duplicates, queued or running chunk builds, removed by the build itself once done
 	TArray<FChunkWorker*>      Workers;
 	TArray<FRunnableThread*>   Threads;
 	FThreadSafeBool            bStopping{false};
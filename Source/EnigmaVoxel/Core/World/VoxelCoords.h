@@ -0,0 +1,77 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "EnigmaVoxel/Core/EVGameInstance.h"
+
+/**
+ * Integer block <-> chunk <-> local conversions. Chunk sizes are powers of two so the
+ * chunk is an arithmetic shift (floor division for negative positions too) and the local
+ * coordinate a mask, no float round trip. Chunks are full columns: the chunk Z is always
+ * 0 and the local Z is the block Z, callers check it against the chunk height.
+ *
+ * The int64 overloads address worlds larger than the int32 block range, chunk coordinates
+ * stay int32 (2^31 chunks of ChunkBlockXCount / ChunkBlockYCount blocks per axis).
+ */
+struct FVoxelCoords
+{
+	static constexpr int32 ChunkShiftX = FChunkLayout::Log2(ChunkBlockXCount);
+	static constexpr int32 ChunkShiftY = FChunkLayout::Log2(ChunkBlockYCount);
+	static constexpr int32 ChunkMaskX  = ChunkBlockXCount - 1;
+	static constexpr int32 ChunkMaskY  = ChunkBlockYCount - 1;
+
+	static_assert((1 << ChunkShiftX) == ChunkBlockXCount && (1 << ChunkShiftY) == ChunkBlockYCount, "Chunk size must be a power of two");
+
+	static FORCEINLINE FIntVector BlockToChunk(const FIntVector& BlockPos)
+	{
+		return FIntVector(BlockPos.X >> ChunkShiftX, BlockPos.Y >> ChunkShiftY, 0);
+	}
+
+	static FORCEINLINE FIntVector BlockToLocal(const FIntVector& BlockPos)
+	{
+		return FIntVector(BlockPos.X & ChunkMaskX, BlockPos.Y & ChunkMaskY, BlockPos.Z);
+	}
+
+	static FORCEINLINE FIntVector ChunkToBlock(const FIntVector& ChunkCoords)
+	{
+		return FIntVector(ChunkCoords.X << ChunkShiftX, ChunkCoords.Y << ChunkShiftY, 0);
+	}
+
+	static FORCEINLINE FIntVector BlockToChunk(const FInt64Vector& BlockPos)
+	{
+		return FIntVector(static_cast<int32>(BlockPos.X >> ChunkShiftX), static_cast<int32>(BlockPos.Y >> ChunkShiftY), 0);
+	}
+
+	static FORCEINLINE FIntVector BlockToLocal(const FInt64Vector& BlockPos)
+	{
+		return FIntVector(static_cast<int32>(BlockPos.X & ChunkMaskX), static_cast<int32>(BlockPos.Y & ChunkMaskY), static_cast<int32>(BlockPos.Z));
+	}
+
+	static FORCEINLINE FInt64Vector ChunkToBlock64(const FIntVector& ChunkCoords)
+	{
+		return FInt64Vector(static_cast<int64>(ChunkCoords.X) << ChunkShiftX, static_cast<int64>(ChunkCoords.Y) << ChunkShiftY, 0);
+	}
+
+	/// The only float step: absolute world position (double with large world coordinates) to the containing block
+	static FORCEINLINE FInt64Vector WorldToBlock64(const FVector& WorldPos)
+	{
+		return FInt64Vector(
+			FMath::FloorToInt64(WorldPos.X / BlockWorldSize),
+			FMath::FloorToInt64(WorldPos.Y / BlockWorldSize),
+			FMath::FloorToInt64(WorldPos.Z / BlockWorldSize));
+	}
+
+	static FORCEINLINE FIntVector WorldToBlock(const FVector& WorldPos)
+	{
+		return FIntVector(
+			FMath::FloorToInt32(WorldPos.X / BlockWorldSize),
+			FMath::FloorToInt32(WorldPos.Y / BlockWorldSize),
+			FMath::FloorToInt32(WorldPos.Z / BlockWorldSize));
+	}
+
+	static FORCEINLINE FVector ChunkToWorld(const FIntVector& ChunkCoords)
+	{
+		return FVector(static_cast<double>(ChunkCoords.X) * ChunkWorldSize, static_cast<double>(ChunkCoords.Y) * ChunkWorldSize, 0.0);
+	}
+};
@@ -11,6 +11,7 @@
 #include "InputActionValue.h"
 #include "EnhancedInputSubsystems.h"
 #include "Engine/LocalPlayer.h"
+#include "EnigmaVoxel/Modules/Net/ChunkStreamComponent.h"
 
 DEFINE_LOG_CATEGORY(LogTemplateCharacter);
 
@@ -20,6 +21,8 @@ AEnigmaVoxelPlayerController::AEnigmaVoxelPlayerController()
 	DefaultMouseCursor = EMouseCursor::Default;
 	CachedDestination  = FVector::ZeroVector;
 	FollowTime         = 0.f;
+
+	ChunkStream = CreateDefaultSubobject<UChunkStreamComponent>(TEXT("ChunkStream"));
 }
 
 void AEnigmaVoxelPlayerController::BeginPlay()
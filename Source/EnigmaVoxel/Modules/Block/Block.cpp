@@ -4,6 +4,35 @@
 #include "Enum/BlockDirection.h"
 
 UMaterialInterface* FBlock::GetFacesMaterial(EBlockDirection Direction) const
+{
+	const FBlockVariantDefinition* Variant = FindVariant();
+	if (!Variant)
+	{
+		return nullptr;
+	}
+
+	UStaticMesh* Mesh = Variant->Model.LoadSynchronous();
+	if (!Mesh)
+	{
+		UE_LOG(LogEnigmaVoxelBlock, Error, TEXT("Block mesh is null for block '%s'"), *Definition->GetName());
+		return nullptr;
+	}
+
+	return Mesh->GetMaterial(static_cast<uint8>(Direction));
+}
+
+int32 FBlock::GetFaceTextureLayer(EBlockDirection Direction) const
+{
+	const FBlockVariantDefinition* Variant = FindVariant();
+	if (!Variant)
+	{
+		return 0;
+	}
+	const int32 Face = static_cast<uint8>(Direction);
+	return Variant->FaceTextureLayers.IsValidIndex(Face) ? Variant->FaceTextureLayers[Face] : 0;
+}
+
+const FBlockVariantDefinition* FBlock::FindVariant() const
 {
 	if (!Definition)
 	{
@@ -11,25 +40,16 @@ UMaterialInterface* FBlock::GetFacesMaterial(EBlockDirection Direction) const
 		return nullptr;
 	}
 
-	FBlockVariantDefinition* Variant = Definition->BlockState.Variants.Find(BlockStateKey);
+	const FBlockVariantDefinition* Variant = Definition->BlockState.Variants.Find(BlockStateKey);
 	if (!Variant)
 	{
 		Variant = Definition->BlockState.Variants.Find(TEXT("")); // fallback default key
 		if (!Variant)
 		{
 			UE_LOG(LogEnigmaVoxelBlock, Warning, TEXT("Cannot find variant for key '%s' in block '%s'"), *BlockStateKey, *Definition->GetName());
-			return nullptr;
 		}
 	}
-
-	UStaticMesh* Mesh = Variant->Model.LoadSynchronous();
-	if (!Mesh)
-	{
-		UE_LOG(LogEnigmaVoxelBlock, Error, TEXT("Block mesh is null for block '%s'"), *Definition->GetName());
-		return nullptr;
-	}
-
-	return Mesh->GetMaterial(static_cast<uint8>(Direction));
+	return Variant;
 }
 
 FBlock::FBlock()
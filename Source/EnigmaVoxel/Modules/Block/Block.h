@@ -1,4 +1,4 @@
-#pragma once
+﻿#pragma once
 
 #include "CoreMinimal.h"
 #include "BlockDefinition.h"
@@ -6,6 +6,37 @@
 
 enum class EBlockDirection : uint8;
 
+/**
+ * Per-block data that only a few blocks carry (damaged while mined, non default state,
+ * block entity payload). Chunks keep it in a sparse map keyed by voxel index next to the
+ * dense block IDs, a block without an entry has the defaults below.
+ */
+struct FBlockExtraData
+{
+	static constexpr int32 DefaultHealth = 100;
+
+	int32         Health        = DefaultHealth;
+	FString       BlockStateKey = "";
+	int32         StateID       = 0;
+	TArray<uint8> Payload; // Opaque block entity data
+
+	bool IsDefault() const
+	{
+		return Health == DefaultHealth && BlockStateKey.IsEmpty() && StateID == 0 && Payload.IsEmpty();
+	}
+
+	friend FArchive& operator<<(FArchive& Ar, FBlockExtraData& Data)
+	{
+		Ar << Data.Health;
+		Ar << Data.BlockStateKey;
+		Ar << Data.StateID;
+		Ar << Data.Payload;
+		return Ar;
+	}
+};
+
+/// Resolved view of a single block (definition, coordinates and extra data). Chunks do not
+/// store FBlock, they store block IDs, so keep it to short-lived queries and edits
 USTRUCT(BlueprintType)
 struct FBlock
 {
@@ -35,8 +66,13 @@ struct FBlock
 	int32 StateID = 0;
 
 	UMaterialInterface* GetFacesMaterial(EBlockDirection Direction) const;
+	int32               GetFaceTextureLayer(EBlockDirection Direction) const;
 
 	FBlock();
 
 	FBlock(const FIntVector& InCoords, UBlockDefinition* InDefinition, int32 InHealth = 100);
+
+private:
+	/// Variant of the current BlockStateKey, the default variant if the key has none
+	const FBlockVariantDefinition* FindVariant() const;
 };
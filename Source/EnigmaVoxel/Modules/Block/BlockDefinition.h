@@ -9,6 +9,8 @@
 #include "UObject/Object.h"
 #include "BlockDefinition.generated.h"
 
+struct FBlockTickContext;
+
 
 /**
  * 
@@ -22,15 +24,23 @@ class ENIGMAVOXEL_API UBlockDefinition : public UDefinition
 public:
 	UBlockDefinition();
 
-	/// Internal Block ID, use for chunk storage
+	/// Internal Block ID, use for chunk storage. Assigned at registration, 0 is air
 	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category="Block Definition")
 	int64 BlockID = 0;
 
 	/// TODO: use block properties builder in the future
 	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category="Block Definition")
 	ECollisionType CollisionType = ECollisionType::UNIT_BLOCK;
+	/// Fills its voxel and hides what is behind it: stops the sky light, tops the height map and closes the
+	/// chunk occlusion graph. Clear it for glass, leaves, half blocks and other see-through content
+	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category="Block Definition")
+	bool bIsOpaque = true;
+	/// Block light level emitted by the block, 0 to 15
+	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category="Block Definition", meta=(ClampMin="0", ClampMax="15"))
+	uint8 LightEmission = 0;
+	/// Sampled by the world random ticks (OnRandomTick), crops growth, leaves decay...
 	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category="Block Definition")
-	bool bIsOpaque = false;
+	bool bRandomTicks = false;
 
 	///If you want to distinguish multiple block states files like Minecraft (such as multiple "subtypes"), you can also change
 	///it to TArray<FBlockState> or TMap<FString, FBlockState>; but most of the time "one block → one block state + multiple
@@ -42,6 +52,11 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Block Definition")
 	int32 DefaultStateID = 0;
 
+	/// Simulation (FBlockTickScheduler), called on a worker thread while the world is frozen.
+	/// Read and edit the world through the context only, the changes are applied after the batch
+	virtual void OnScheduledTick(FBlockTickContext& Context) const {}
+	virtual void OnRandomTick(FBlockTickContext& Context) const {}
+
 	/// We like Minecraft so we use their method
 		/// Destroy logic could look Neo forge implementation quite perfect
 
@@ -4,6 +4,7 @@
 #include "BlockRegister.h"
 #include "BlockDefinition.h"
 #include "EnigmaVoxel/EnigmaVoxel.h"
+#include "EnigmaVoxel/Core/Register/EnigmaRegistrationSubsystem.h"
 
 bool UBlockRegister::RegisterFromDataTable(UDataTable* DataTable)
 {
@@ -23,7 +24,8 @@ bool UBlockRegister::RegisterFromDef(TSubclassOf<UDefinition> definition)
 		UE_LOG(LogEnigmaVoxel, Warning, TEXT("You had register duplicated ID object -> %s"), *block->ID);
 	}
 	RegisterContext.Add(block);
-	UE_LOG(LogEnigmaVoxel, Log, TEXT("Registered Block object -> %s"), *block->ID);
+	UEnigmaRegistrationSubsystem::BLOCK_ASSIGN_ID(block);
+	UE_LOG(LogEnigmaVoxel, Log, TEXT("Registered Block object -> %s (BlockID %lld)"), *block->ID, block->BlockID);
 	return true;
 }
 
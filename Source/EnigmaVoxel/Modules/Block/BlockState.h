@@ -11,6 +11,11 @@ struct FBlockVariantDefinition
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Block State")
 	TSoftObjectPtr<UStaticMesh> Model;
 
+	// Layer of each face in the chunk texture array, indexed by EBlockDirection, a missing face uses layer 0.
+	// Only read when the world meshes with a texture array material (UEnigmaWorld::TextureArrayMaterial)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Block State")
+	TArray<int32> FaceTextureLayers;
+
 	// If you have other information, such as material, collision, UV information, you can put it here:
 	// UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Block State")
 	// UMaterialInterface* OverrideMaterial = nullptr;
@@ -0,0 +1,72 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "BlockTick.h"
+#include "BlockDefinition.h"
+#include "EnigmaVoxel/Core/World/VoxelCoords.h"
+#include "EnigmaVoxel/Modules/Chunk/ChunkHolder.h"
+
+FBlockTickContext::FBlockTickContext(const FIntVector& InBlockPos, int64 InWorldTick, FRandomStream& InRandom, FVoxelBlockLookup InLookup, FBlockTickResult& InResult)
+	: BlockPos(InBlockPos)
+	, WorldTick(InWorldTick)
+	, Random(InRandom)
+	, Lookup(InLookup)
+	, Result(InResult)
+{
+}
+
+UBlockDefinition* FBlockTickContext::GetBlock(const FIntVector& InBlockPos) const
+{
+	return Lookup(InBlockPos);
+}
+
+void FBlockTickContext::SetBlock(const FIntVector& InBlockPos, UBlockDefinition* Definition)
+{
+	Result.Changes.Emplace(InBlockPos, Definition);
+}
+
+void FBlockTickContext::ScheduleTick(const FIntVector& InBlockPos, int32 DelayTicks)
+{
+	Result.Schedules.Emplace(InBlockPos, DelayTicks);
+}
+
+void FBlockTickScheduler::TickChunk(FChunkHolder& Holder, int64 WorldTick, int32 RandomTickCount, FVoxelBlockLookup Lookup, FBlockTickResult& OutResult)
+{
+	FRandomStream    Random(static_cast<int32>(HashCombineFast(GetTypeHash(Holder.Coords), GetTypeHash(WorldTick))));
+	const FIntVector Origin = FVoxelCoords::ChunkToBlock(Holder.Coords);
+
+	// Ticks scheduled during this batch go through the world, they are at least one tick away
+	while (Holder.ScheduledTicks.Num() > 0 && Holder.ScheduledTicks.HeapTop().DueTick <= WorldTick)
+	{
+		FScheduledBlockTick Tick;
+		Holder.ScheduledTicks.HeapPop(Tick, EAllowShrinking::No);
+		if (const UBlockDefinition* Definition = FChunkHolder::ResolveBlockID(Holder.GetBlockID(Tick.LocalCoords)))
+		{
+			FBlockTickContext Context(Origin + Tick.LocalCoords, WorldTick, Random, Lookup, OutResult);
+			Definition->OnScheduledTick(Context);
+		}
+	}
+
+	if (Holder.IsEmpty())
+	{
+		return;
+	}
+	for (int32 i = 0; i < RandomTickCount; ++i)
+	{
+		const FIntVector        Local(Random.RandHelper(FChunkLayout::SizeX), Random.RandHelper(FChunkLayout::SizeY), Random.RandHelper(FChunkLayout::SizeZ));
+		const UBlockDefinition* Definition = FChunkHolder::ResolveBlockID(Holder.GetBlockID(Local));
+		if (Definition && Definition->bRandomTicks)
+		{
+			FBlockTickContext Context(Origin + Local, WorldTick, Random, Lookup, OutResult);
+			Definition->OnRandomTick(Context);
+		}
+	}
+}
+
+void FBlockTickScheduler::Schedule(FChunkHolder& Holder, const FIntVector& LocalCoords, int64 DueTick, uint64 Sequence)
+{
+	FScheduledBlockTick Tick;
+	Tick.LocalCoords = LocalCoords;
+	Tick.DueTick     = DueTick;
+	Tick.Sequence    = Sequence;
+	Holder.ScheduledTicks.HeapPush(Tick);
+}
@@ -0,0 +1,66 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "EnigmaVoxel/Core/World/Query/VoxelQuery.h"
+
+class UBlockDefinition;
+struct FChunkHolder;
+
+/// A block update waiting in the queue of its chunk
+struct FScheduledBlockTick
+{
+	FIntVector LocalCoords = FIntVector::ZeroValue;
+	int64      DueTick     = 0; // World block tick it runs at
+	uint64     Sequence    = 0; // World-wide scheduling order, ticks due together run in it
+
+	/// Heap order, the earliest tick is on top
+	bool operator<(const FScheduledBlockTick& Other) const
+	{
+		return DueTick != Other.DueTick ? DueTick < Other.DueTick : Sequence < Other.Sequence;
+	}
+};
+
+/// What the ticks of one chunk asked for, applied by the world on the game thread in chunk order
+struct FBlockTickResult
+{
+	TArray<TPair<FIntVector, UBlockDefinition*>> Changes; // World block position and new block, nullptr is air
+	TArray<TPair<FIntVector, int32>>             Schedules; // World block position and delay in world ticks
+};
+
+/**
+ * Handed to the tick callbacks of a block definition. Chunks tick in parallel against a
+ * frozen world: a callback reads blocks through the context and records its changes, the
+ * world applies them after the batch.
+ */
+struct ENIGMAVOXEL_API FBlockTickContext
+{
+	FBlockTickContext(const FIntVector& InBlockPos, int64 InWorldTick, FRandomStream& InRandom, FVoxelBlockLookup InLookup, FBlockTickResult& InResult);
+
+	const FIntVector BlockPos; // World block position of the ticked block
+	const int64      WorldTick;
+	FRandomStream&   Random; // Seeded from the chunk and the world tick, a run replays identically
+
+	UBlockDefinition* GetBlock(const FIntVector& InBlockPos) const; // nullptr for air or a chunk not loaded
+	void              SetBlock(const FIntVector& InBlockPos, UBlockDefinition* Definition); // nullptr places air
+	void              ScheduleTick(const FIntVector& InBlockPos, int32 DelayTicks);
+
+private:
+	FVoxelBlockLookup Lookup;
+	FBlockTickResult& Result;
+};
+
+/**
+ * Block simulation of one chunk: the due scheduled ticks (fluids, falling blocks...) in
+ * order, then a few random ticks (crops growth...) sampled across the chunk.
+ */
+struct FBlockTickScheduler
+{
+	/// Run the ticks of a chunk, chunks of one batch can run in parallel
+	/// @param RandomTickCount Voxels sampled for a random tick, only bRandomTicks blocks receive it
+	static void TickChunk(FChunkHolder& Holder, int64 WorldTick, int32 RandomTickCount, FVoxelBlockLookup Lookup, FBlockTickResult& OutResult);
+
+	/// Queue a block update in its chunk, game thread
+	static void Schedule(FChunkHolder& Holder, const FIntVector& LocalCoords, int64 DueTick, uint64 Sequence);
+};
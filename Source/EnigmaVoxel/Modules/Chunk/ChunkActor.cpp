@@ -4,20 +4,21 @@
 #include "ChunkActor.h"
 
 #include "ChunkHolder.h"
+#include "PhysicsEngine/AggregateGeom.h"
 #include "EnigmaVoxel/Core/Log/DefinedLog.h"
 #include "EnigmaVoxel/Core/Register/EnigmaRegistrationSubsystem.h"
-#include "EnigmaVoxel/Modules/Block/Enum/BlockDirection.h"
+#include "EnigmaVoxel/Core/World/EnigmaWorld.h"
+#include "EnigmaVoxel/Core/World/EnigmaWorldSubsystem.h"
+#include "EnigmaVoxel/Core/World/VoxelCoords.h"
+#include "Engine/GameInstance.h"
 
 
 // Sets default values
 AChunkActor::AChunkActor()
 {
-	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
+	// Pure render and collision proxy, blocks are simulated by the world block tick per chunk
+	PrimaryActorTick.bCanEverTick = false;
 	CollisionDynamicMeshComponent = CreateDefaultSubobject<UDynamicMeshComponent>(TEXT("Collision Dynamic Mesh"));
-	// Reserve the block slot
-	Blocks.Reserve(GetChunkBlockSize());
-	Blocks.Init(FBlock(), GetChunkBlockSize());
 	// Collision
 	if (DynamicMeshComponent)
 	{
@@ -27,6 +28,16 @@ AChunkActor::AChunkActor()
 		// 如果只想用简单碰撞或无碰撞，也可配置 bUseComplexAsSimpleCollision = false;
 		DynamicMeshComponent->SetComplexAsSimpleCollisionEnabled(false);
 	}
+	// Simple box collision only, filled by UpdateChunkCollision
+	if (CollisionDynamicMeshComponent)
+	{
+		CollisionDynamicMeshComponent->SetupAttachment(DynamicMeshComponent);
+		CollisionDynamicMeshComponent->SetHiddenInGame(true);
+		CollisionDynamicMeshComponent->SetCollisionProfileName(UCollisionProfile::BlockAll_ProfileName);
+		CollisionDynamicMeshComponent->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
+		CollisionDynamicMeshComponent->SetGenerateOverlapEvents(false);
+		CollisionDynamicMeshComponent->SetComplexAsSimpleCollisionEnabled(false, false);
+	}
 }
 
 // Called when the game starts or when spawned
@@ -35,239 +46,119 @@ void AChunkActor::BeginPlay()
 	Super::BeginPlay();
 }
 
-int32 AChunkActor::GetChunkBlockSize()
-{
-	return ChunkDimension.X * ChunkDimension.Y * ChunkDimension.Z;
-}
-
-FBlock& AChunkActor::GetBlockAt(FIntVector InCoords)
-{
-	int32 Index = GetBlockIndexAt(InCoords);
-	//check(Blocks.IsValidIndex(Index));
-	return Blocks[Index];
-}
-
-int32 AChunkActor::GetBlockIndexAt(FIntVector InCoords)
+bool AChunkActor::UpdateChunkMaterial(FChunkHolder& InChunkHolder)
 {
-	return InCoords.X
-		+ InCoords.Y * ChunkDimension.X
-		+ InCoords.Z * ChunkDimension.X * ChunkDimension.Y;
+	for (auto& P : InChunkHolder.MaterialToSection)
+	{
+		DynamicMeshComponent->SetMaterial(P.Value, P.Key);
+	}
+	DynamicMeshComponent->NotifyMeshUpdated();
+	return true;
 }
 
-bool AChunkActor::IsVisibleFace(FBlock& currentBlock, EBlockDirection InDirection)
+void AChunkActor::UpdateChunkCollision(const TArray<FBox>& InBoxes)
 {
-	FIntVector3 blockPos = currentBlock.Coordinates;
-	switch (InDirection)
+	if (!CollisionDynamicMeshComponent)
 	{
-	case EBlockDirection::NORTH:
-		if (blockPos.X + 1 >= ChunkDimension.X)
-		{
-			return true;
-		}
-		blockPos.X += 1;
-		if (GetBlockAt(blockPos).Definition == nullptr)
-		{
-			return true;
-		}
-		return false;
-	case EBlockDirection::SOUTH:
-		if (blockPos.X - 1 < 0)
-		{
-			return true;
-		}
-		blockPos.X -= 1;
-		if (GetBlockAt(blockPos).Definition == nullptr)
-		{
-			return true;
-		}
-		return false;
-	case EBlockDirection::EAST:
-		if (blockPos.Y + 1 >= ChunkDimension.Y)
-		{
-			return true;
-		}
-		blockPos.Y += 1;
-		if (GetBlockAt(blockPos).Definition == nullptr)
-		{
-			return true;
-		}
-		return false;
-	case EBlockDirection::WEST:
-		if (blockPos.Y - 1 < 0)
-		{
-			return true;
-		}
-		blockPos.Y -= 1;
-		if (GetBlockAt(blockPos).Definition == nullptr)
-		{
-			return true;
-		}
-		return false;
-	case EBlockDirection::UP:
-		if (blockPos.Z + 1 >= ChunkDimension.Z)
-		{
-			return true;
-		}
-		blockPos.Z += 1;
-		if (GetBlockAt(blockPos).Definition == nullptr)
-		{
-			return true;
-		}
-		return false;
-	case EBlockDirection::DOWN:
-		if (blockPos.Z - 1 < 0)
-		{
-			return true;
-		}
-		blockPos.Z -= 1;
-		if (GetBlockAt(blockPos).Definition == nullptr)
-		{
-			return true;
-		}
-		return false;
+		return;
+	}
+	FKAggregateGeom AggGeom;
+	AggGeom.BoxElems.Reserve(InBoxes.Num());
+	for (const FBox& Box : InBoxes)
+	{
+		const FVector Size = Box.GetSize();
+		FKBoxElem&    Elem = AggGeom.BoxElems.Emplace_GetRef(Size.X, Size.Y, Size.Z);
+		Elem.Center        = Box.GetCenter();
 	}
-	return false;
+	CollisionDynamicMeshComponent->SetSimpleCollisionShapes(AggGeom, true);
 }
 
-bool AChunkActor::UpdateBlock(FBlock InBlockData)
+void AChunkActor::DeactivateToPool()
 {
-	Blocks[GetBlockIndexAt(InBlockData.Coordinates)] = InBlockData;
-	//UE_LOG(LogEnigmaVoxelChunk, Log, TEXT("UpdateBlock in Chunk -> %s at -> %s"), *GetName(), *InBlockData.Coordinates.ToString())
-	if (InBlockData.Definition == nullptr)
+	SetActorHiddenInGame(true);
+	SetActorEnableCollision(false);
+	SetActorTickEnabled(false);
+	if (DynamicMeshComponent)
 	{
-		return false;
+		DynamicMeshComponent->GetDynamicMesh()->Reset();
+	}
+	if (CollisionDynamicMeshComponent)
+	{
+		CollisionDynamicMeshComponent->GetDynamicMesh()->Reset();
+		CollisionDynamicMeshComponent->ClearSimpleCollisionShapes(true);
 	}
-	return true;
 }
 
-bool AChunkActor::UpdateBlockResourceLocation(FIntVector InCoords, FString Namespace, FString Path)
+void AChunkActor::ActivateFromPool(const FVector& InOrigin)
 {
-	UBlockDefinition* def   = UEnigmaRegistrationSubsystem::BLOCK_GET_VALUE(Namespace, Path);
-	FBlock            Block = FBlock(InCoords, def, 100);
-	return UpdateBlock(Block);
+	SetActorLocation(InOrigin, false, nullptr, ETeleportType::TeleportPhysics);
+	SetActorEnableCollision(true);
+	SetActorHiddenInGame(false);
 }
 
-bool AChunkActor::UpdateChunk()
+UEnigmaWorld* AChunkActor::FindOwningWorld(FIntVector& OutChunkCoords) const
 {
-	if (!DynamicMeshComponent)
+	const UGameInstance*         GameInstance = GetWorld() ? GetWorld()->GetGameInstance() : nullptr;
+	const UEnigmaWorldSubsystem* Subsystem    = GameInstance ? GameInstance->GetSubsystem<UEnigmaWorldSubsystem>() : nullptr;
+	if (!Subsystem)
 	{
-		UE_LOG(LogEnigmaVoxelChunk, Error, TEXT("Fail to get DynamicMeshComponent in Chunk -> %s"), *GetName())
-		return false;
+		return nullptr;
 	}
-	DynamicMeshComponent->GetDynamicMesh()->Reset();
-	UE_LOG(LogEnigmaVoxelChunk, Log, TEXT("Successful create new dynamic mesh in Chunk -> %s"), *GetName());
-	for (FBlock& Block : Blocks)
+	for (const TPair<int32, TObjectPtr<UEnigmaWorld>>& World : Subsystem->LoadedWorlds)
 	{
-		if (Block.Definition != nullptr)
+		if (!World.Value)
+		{
+			continue;
+		}
+		if (const FIntVector* ChunkCoords = World.Value->LoadedChunks.FindKey(this))
 		{
-			AppendBoxWithCollision(Block);
+			OutChunkCoords = *ChunkCoords;
+			return World.Value;
 		}
 	}
-	return false;
+	return nullptr;
 }
 
-bool AChunkActor::UpdateChunkMaterial(FChunkHolder& InChunkHolder)
+bool AChunkActor::UpdateBlockResourceLocation(FIntVector InCoords, FString Namespace, FString Path)
 {
-	for (auto& P : InChunkHolder.MaterialToSection)
+	FIntVector    ChunkCoords;
+	UEnigmaWorld* World = FindOwningWorld(ChunkCoords);
+	if (!World || !FChunkLayout::IsInside(InCoords))
 	{
-		DynamicMeshComponent->SetMaterial(P.Value, P.Key);
+		UE_LOG(LogEnigmaVoxelChunk, Warning, TEXT("Chunk -> %s can not set block %s, not drawn by a world or outside the chunk"), *GetName(), *InCoords.ToString());
+		return false;
 	}
-	DynamicMeshComponent->NotifyMeshUpdated();
-	return true;
+	UBlockDefinition* Definition = UEnigmaRegistrationSubsystem::BLOCK_GET_VALUE(Namespace, Path);
+	return Definition && World->SetBlockAtBlockPos(FVoxelCoords::ChunkToBlock(ChunkCoords) + InCoords, Definition);
 }
 
+bool AChunkActor::UpdateChunk()
+{
+	return true;
+}
 
 bool AChunkActor::FillChunkWithXYZ(FIntVector fillArea, FString Namespace, FString Path)
 {
-	for (int z = 0; z < fillArea.Z; z++)
+	// One world lookup and one registry lookup for the whole area
+	FIntVector        ChunkCoords;
+	UEnigmaWorld*     World      = FindOwningWorld(ChunkCoords);
+	UBlockDefinition* Definition = UEnigmaRegistrationSubsystem::BLOCK_GET_VALUE(Namespace, Path);
+	if (!World || !Definition)
+	{
+		return false;
+	}
+	const FIntVector Origin = FVoxelCoords::ChunkToBlock(ChunkCoords);
+	const FIntVector Area   = fillArea.ComponentMin(FChunkLayout::GetDimension());
+	bool             bAll   = true;
+	for (int z = 0; z < Area.Z; z++)
 	{
-		for (int y = 0; y < fillArea.Y; y++)
+		for (int y = 0; y < Area.Y; y++)
 		{
-			for (int x = 0; x < fillArea.X; x++)
+			for (int x = 0; x < Area.X; x++)
 			{
-				UpdateBlockResourceLocation(FIntVector(x, y, z), Namespace, Path);
+				bAll &= World->SetBlockAtBlockPos(Origin + FIntVector(x, y, z), Definition);
 			}
 		}
 	}
-	return false;
-}
-
-void AChunkActor::AppendBoxWithCollision(FBlock& Block)
-{
-	FIntVector blockPos          = Block.Coordinates;
-	FVector    blockVertMinPoint = FVector(blockPos.X * 100, blockPos.Y * 100, blockPos.Z * 100);
-	FVector    blockVertMaxPoint = FVector(blockVertMinPoint.X + 100, blockVertMinPoint.Y + 100, blockVertMinPoint.Z + 100);
-	FBox3d     box               = FBox3d(blockVertMinPoint, blockVertMaxPoint);
-	FVector3d  BoxMin            = box.Min;
-	FVector3d  BoxMax            = box.Max;
-
-	UDynamicMesh*  DynamicMesh = DynamicMeshComponent->GetDynamicMesh();
-	FDynamicMesh3& mesh        = DynamicMesh->GetMeshRef();
-
-	int32 v0 = mesh.AppendVertex(FVector(BoxMax.X, BoxMin.Y, BoxMin.Z));
-	int32 v1 = mesh.AppendVertex(FVector(BoxMax.X, BoxMax.Y, BoxMin.Z));
-	int32 v2 = mesh.AppendVertex(FVector(BoxMax.X, BoxMax.Y, BoxMax.Z));
-	int32 v3 = mesh.AppendVertex(FVector(BoxMax.X, BoxMin.Y, BoxMax.Z));
-	int32 v4 = mesh.AppendVertex(FVector(BoxMin.X, BoxMax.Y, BoxMin.Z));
-	int32 v5 = mesh.AppendVertex(FVector(BoxMin.X, BoxMin.Y, BoxMin.Z));
-	int32 v6 = mesh.AppendVertex(FVector(BoxMin.X, BoxMin.Y, BoxMax.Z));
-	int32 v7 = mesh.AppendVertex(FVector(BoxMin.X, BoxMax.Y, BoxMax.Z));
-
-	// +x faces
-	if (IsVisibleFace(Block, EBlockDirection::NORTH))
-	{
-		//int sectionID = GetSectionIndexForMaterial(Block.GetFacesMaterial(EBlockDirection::NORTH));
-		mesh.AppendTriangle(v1, v0, v3);
-		mesh.AppendTriangle(v1, v3, v2);
-	}
-
-	// -x faces
-	if (IsVisibleFace(Block, EBlockDirection::SOUTH))
-	{
-		//int sectionID = GetSectionIndexForMaterial(Block.GetFacesMaterial(EBlockDirection::SOUTH));
-		mesh.AppendTriangle(v5, v4, v7);
-		mesh.AppendTriangle(v5, v7, v6);
-	}
-	// -y faces
-	if (IsVisibleFace(Block, EBlockDirection::EAST))
-	{
-		//int sectionID = GetSectionIndexForMaterial(Block.GetFacesMaterial(EBlockDirection::EAST));
-		mesh.AppendTriangle(v4, v1, v2);
-		mesh.AppendTriangle(v4, v2, v7);
-	}
-	// +y faces
-	if (IsVisibleFace(Block, EBlockDirection::WEST))
-	{
-		//int sectionID = GetSectionIndexForMaterial(Block.GetFacesMaterial(EBlockDirection::WEST));
-		mesh.AppendTriangle(v0, v5, v6);
-		mesh.AppendTriangle(v0, v6, v3);
-	}
-	// -z faces
-	if (IsVisibleFace(Block, EBlockDirection::DOWN))
-	{
-		//int sectionID = GetSectionIndexForMaterial(Block.GetFacesMaterial(EBlockDirection::DOWN));
-		mesh.AppendTriangle(v5, v0, v1);
-		mesh.AppendTriangle(v5, v1, v4);
-	}
-	// +z faces
-	if (IsVisibleFace(Block, EBlockDirection::UP))
-	{
-		//int sectionID = GetSectionIndexForMaterial(Block.GetFacesMaterial(EBlockDirection::UP));
-		mesh.AppendTriangle(v2, v3, v6);
-		mesh.AppendTriangle(v2, v6, v7);
-	}
-	DynamicMeshComponent->SetDynamicMesh(DynamicMesh);
-	//DynamicMeshComponent->NotifyMeshUpdated();
-	/*
-	DynamicMeshComponent->ClearSimpleCollisionShapes(false);
-	DynamicMeshComponent->SetSimpleCollisionShapes(DynamicMeshComponent->GetSimpleCollisionShapes(),true);*/
-	//DynamicMeshComponent->UpdateCollision();
-	UE_LOG(LogEnigmaVoxelBlock, Display, TEXT("Append new Block triangles -> %s"), *Block.Coordinates.ToString());
-}
-
-
-// Called every frame
-void AChunkActor::Tick(float DeltaTime)
-{
-	Super::Tick(DeltaTime);
+	return bAll;
 }
@@ -3,13 +3,14 @@
 #pragma once
 
 #include "CoreMinimal.h"
-#include "EnigmaVoxel/Modules/Block/Block.h"
 #include "Runtime/GeometryFramework/Public/DynamicMeshActor.h"
 #include "ChunkActor.generated.h"
 
 
+class UEnigmaWorld;
 struct FChunkHolder;
 
+/// Render and collision proxy of a chunk, the block data lives in the world FChunkHolder
 UCLASS()
 class ENIGMAVOXEL_API AChunkActor : public ADynamicMeshActor
 {
@@ -28,61 +29,32 @@ protected:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	TObjectPtr<UDynamicMeshComponent> CollisionDynamicMeshComponent;
 
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Block")
-	FIntVector ChunkDimension = FIntVector(16, 16, 16);
-	UPROPERTY(BlueprintReadWrite, EditAnywhere)
-	TArray<FBlock> Blocks;
-
-	UFUNCTION(BlueprintCallable)
-	int32 GetChunkBlockSize();
-
-	// Query
-	UFUNCTION(BlueprintCallable)
-	FBlock& GetBlockAt(FIntVector InCoords);
-	UFUNCTION(BlueprintCallable)
-	int32 GetBlockIndexAt(FIntVector InCoords);
-	UFUNCTION(BlueprintCallable)
-	bool IsVisibleFace(FBlock& currentBlock, EBlockDirection InDirection);
-
 public:
-	// Setter
-	/// Update Block by using FBlock Data, if the Block Definition inside
-	/// FBlock is null the method will return false else return true. The
-	/// null BlockDefinition will not be rendered
-	/// @param InBlockData 
-	/// @return whether or not the Definition is null
-	UFUNCTION(BlueprintCallable)
-	bool UpdateBlock(FBlock InBlockData);
-	/// Update Block by using Block position, and resource location, this method
-	/// would query the registration system for once and execute @seeUpdateBlock(FBlock InBlockData)
-	/// It will return null if the Block Definition is null
-	/// @param InCoords The block coords you want to replace
-	/// @param Namespace The Namespace of the block Definition
-	/// @param Path ThePath of the block Definition
-	/// @return whether or not the Definition is null
-	UFUNCTION(BlueprintCallable)
+	bool UpdateChunkMaterial(FChunkHolder& InChunkHolder);
+	/// Replace the simple collision of the collision component by the box set
+	/// built on the worker, boxes do not need cooking unlike a trimesh
+	/// @param InBoxes Merged solid voxels in actor local space
+	void UpdateChunkCollision(const TArray<FBox>& InBoxes);
+
+	/// Park the actor inside the world chunk actor pool, the actor is hidden,
+	/// collision is disabled and both dynamic meshes are released
+	void DeactivateToPool();
+	/// Bring a parked actor back, only the transform changes, the chunk mesh
+	/// is swapped in by the caller afterward
+	/// @param InOrigin The world origin of the chunk the actor will represent
+	void ActivateFromPool(const FVector& InOrigin);
+
+	/// Legacy block API, kept until BPA_Chunk is migrated. The actor holds no blocks anymore, edits go
+	/// to the world that draws it. Coordinates are local to the chunk
+	UFUNCTION(BlueprintCallable, meta=(DeprecatedFunction, DeprecationMessage="Use UEnigmaWorld::SetBlockAtBlockPos"))
 	bool UpdateBlockResourceLocation(FIntVector InCoords, FString Namespace = "Enigma", FString Path = "");
-
-	/// Rebuild the whole chunk, it will read the Block Data Array from the beginning
-	/// clear the current Dynamic Mesh also the Collision Dynamic Mesh
-	/// @return whether or not rebuild successful
-	UFUNCTION(BlueprintCallable)
+	/// The world remeshes an edited chunk by itself, nothing to do
+	UFUNCTION(BlueprintCallable, meta=(DeprecatedFunction, DeprecationMessage="Chunks are remeshed by UEnigmaWorld after every edit"))
 	bool UpdateChunk();
-	bool UpdateChunkMaterial(FChunkHolder& InChunkHolder);
-
-	/// Utility Function Right now for quickly fill the chunk with blocks
-	/// TODO: the functions inside chunk will move to world subsystem perhaps
-	UFUNCTION(BlueprintCallable)
+	UFUNCTION(BlueprintCallable, meta=(DeprecatedFunction, DeprecationMessage="Use UEnigmaWorld::SetBlockAtBlockPos"))
 	bool FillChunkWithXYZ(FIntVector fillArea, FString Namespace = "Enigma", FString Path = "");
 
 private:
-	/// Append Box to current Chunk dynamic mesh, this method would also
-	/// append additional Collision verts into Collision dynamic mesh.
-	/// The condition of collision will dependent on block definition properties
-	/// @param Block The Block slot of The chunk
-	void AppendBoxWithCollision(FBlock& Block);
-
-public:
-	// Called every frame
-	virtual void Tick(float DeltaTime) override;
+	/// World whose LoadedChunks holds this actor, nullptr for a pooled or foreign actor
+	UEnigmaWorld* FindOwningWorld(FIntVector& OutChunkCoords) const;
 };
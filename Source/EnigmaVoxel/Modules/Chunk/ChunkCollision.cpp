@@ -0,0 +1,141 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ChunkCollision.h"
+#include "ChunkHolder.h"
+#include "EnigmaVoxel/Modules/Block/BlockDefinition.h"
+
+namespace
+{
+	enum class EVoxelCollision : uint8
+	{
+		None,
+		Full,
+		Half
+	};
+
+	EVoxelCollision GetVoxelCollision(const UBlockDefinition* Definition)
+	{
+		if (!Definition)
+		{
+			return EVoxelCollision::None;
+		}
+		switch (Definition->CollisionType)
+		{
+		case ECollisionType::UNIT_BLOCK_HALF:
+			return EVoxelCollision::Half;
+		case ECollisionType::CUSTOM: // No custom shape data yet, fall back to the full cube
+		case ECollisionType::UNIT_BLOCK:
+		default:
+			return EVoxelCollision::Full;
+		}
+	}
+}
+
+void FChunkCollision::BuildBoxes(const FChunkHolder& Holder, TArray<FBox>& OutBoxes)
+{
+	OutBoxes.Reset();
+	if (Holder.IsEmpty())
+	{
+		return;
+	}
+
+	const float     Size  = Holder.BlockSize;
+	constexpr int32 Count = FChunkLayout::Count;
+
+	// Classify once, the greedy pass below reads every voxel several times
+	TArray<EVoxelCollision> Kinds;
+	Kinds.SetNumUninitialized(Count);
+	uint16          LastID   = 0;
+	EVoxelCollision LastKind = EVoxelCollision::None;
+	for (int32 i = 0; i < Count; ++i)
+	{
+		// Runs of the same block are the common case, resolve the definition on change only
+		const uint16 BlockID = Holder.GetBlockIDAt(i);
+		if (BlockID != LastID)
+		{
+			LastID   = BlockID;
+			LastKind = GetVoxelCollision(FChunkHolder::ResolveBlockID(BlockID));
+		}
+		Kinds[i] = LastKind;
+	}
+	TBitArray<> Visited(false, Count);
+
+	auto Index = [](int x, int y, int z)
+	{
+		return FChunkLayout::Index(x, y, z);
+	};
+	auto IsFree = [&](int x, int y, int z, EVoxelCollision Kind)
+	{
+		const int32 I = Index(x, y, z);
+		return Kinds[I] == Kind && !Visited[I];
+	};
+
+	for (int z = 0; z < FChunkLayout::SizeZ; ++z)
+	{
+		for (int y = 0; y < FChunkLayout::SizeY; ++y)
+		{
+			for (int x = 0; x < FChunkLayout::SizeX; ++x)
+			{
+				const EVoxelCollision Kind = Kinds[Index(x, y, z)];
+				if (Kind == EVoxelCollision::None || Visited[Index(x, y, z)])
+				{
+					continue;
+				}
+
+				// Grow along X
+				int x1 = x + 1;
+				while (x1 < FChunkLayout::SizeX && IsFree(x1, y, z, Kind))
+				{
+					++x1;
+				}
+
+				// Grow along Y while the whole X run is free
+				int y1 = y + 1;
+				for (; y1 < FChunkLayout::SizeY; ++y1)
+				{
+					bool bRowFree = true;
+					for (int xx = x; xx < x1 && bRowFree; ++xx)
+					{
+						bRowFree = IsFree(xx, y1, z, Kind);
+					}
+					if (!bRowFree)
+					{
+						break;
+					}
+				}
+
+				// Grow along Z while the whole XY rectangle is free, half blocks leave a gap so they never stack
+				int z1 = z + 1;
+				for (; Kind == EVoxelCollision::Full && z1 < FChunkLayout::SizeZ; ++z1)
+				{
+					bool bLayerFree = true;
+					for (int yy = y; yy < y1 && bLayerFree; ++yy)
+					{
+						for (int xx = x; xx < x1 && bLayerFree; ++xx)
+						{
+							bLayerFree = IsFree(xx, yy, z1, Kind);
+						}
+					}
+					if (!bLayerFree)
+					{
+						break;
+					}
+				}
+
+				for (int zz = z; zz < z1; ++zz)
+				{
+					for (int yy = y; yy < y1; ++yy)
+					{
+						for (int xx = x; xx < x1; ++xx)
+						{
+							Visited[Index(xx, yy, zz)] = true;
+						}
+					}
+				}
+
+				const float Top = Kind == EVoxelCollision::Half ? static_cast<float>(z) + 0.5f : static_cast<float>(z1);
+				OutBoxes.Add(FBox(FVector(x, y, z) * Size, FVector(x1, y1, Top) * Size));
+			}
+		}
+	}
+}
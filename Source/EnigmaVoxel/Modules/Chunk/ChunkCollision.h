@@ -0,0 +1,19 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FChunkHolder;
+
+/**
+ * Simplified chunk collision built on the worker threads. Solid voxels are merged into
+ * axis-aligned boxes by greedy decomposition (grow along X, then Y, then Z), the box set
+ * is uploaded as simple collision on the chunk actor so physics never cooks a trimesh.
+ *
+ * Boxes are in chunk local space (the actor origin), in Unreal units.
+ */
+struct FChunkCollision
+{
+	static void BuildBoxes(const FChunkHolder& Holder, TArray<FBox>& OutBoxes);
+};
@@ -4,14 +4,119 @@
 #include "EnigmaVoxel/Core/Log/DefinedLog.h"
 #include "EnigmaVoxel/Core/Register/EnigmaRegistrationSubsystem.h"
 #include "EnigmaVoxel/Core/World/EnigmaWorld.h"
+#include "EnigmaVoxel/Core/World/VoxelCoords.h"
 #include "EnigmaVoxel/Modules/Block/Block.h"
 #include "EnigmaVoxel/Modules/Block/Enum/BlockDirection.h"
+#include "ChunkWarmCache.h"
+
+namespace
+{
+	/// Unit cube corners, same layout as the historical 8 vertex box
+	const FIntVector CubeCorners[8] = {
+		{1, 0, 0}, {1, 1, 0}, {1, 1, 1}, {1, 0, 1},
+		{0, 1, 0}, {0, 0, 0}, {0, 0, 1}, {0, 1, 1}
+	};
+
+	/// Corners of each face indexed by EBlockDirection, triangles are (0,1,2) and (0,2,3)
+	const int32 FaceCorners[6][4] = {
+		{4, 1, 2, 7}, // EAST  +Y
+		{0, 5, 6, 3}, // WEST  -Y
+		{2, 3, 6, 7}, // UP    +Z
+		{5, 0, 1, 4}, // DOWN  -Z
+		{5, 4, 7, 6}, // SOUTH -X
+		{1, 0, 3, 2}  // NORTH +X
+	};
+
+	const FIntVector FaceOffsets[6] = {
+		{0, 1, 0}, {0, -1, 0},
+		{0, 0, 1}, {0, 0, -1},
+		{-1, 0, 0}, {1, 0, 0}
+	};
+
+	/// Texture coordinates of the face corners, sides are upright (V goes down)
+	const FVector2f FaceUVs[4] = {
+		{0.f, 1.f}, {1.f, 1.f}, {1.f, 0.f}, {0.f, 0.f}
+	};
+
+	/// Axis the U and V coordinates run along for each face, indexed by EBlockDirection
+	const int32 FaceUVAxes[6][2] = {
+		{0, 2}, // EAST
+		{0, 2}, // WEST
+		{1, 0}, // UP
+		{0, 1}, // DOWN
+		{1, 2}, // SOUTH
+		{1, 2}  // NORTH
+	};
+
+	const EBlockDirection AllDirections[6] = {
+		EBlockDirection::NORTH, EBlockDirection::SOUTH,
+		EBlockDirection::EAST, EBlockDirection::WEST,
+		EBlockDirection::DOWN, EBlockDirection::UP
+	};
+}
 
 FChunkHolder::FChunkHolder()
 {
-	int32 Size = Dimension.X * Dimension.Y * Dimension.Z;
-	Blocks.SetNum(Size);
-	MaterialToSection.Reserve(Size);
+	MaterialToSection.Reserve(ExpectedMaterialCount);
+}
+
+/// Bring the holder back to a freshly constructed state while keeping the
+/// block array and material map allocation, used by FChunkHolderPool
+void FChunkHolder::ResetForReuse()
+{
+	Coords               = FIntVector::ZeroValue;
+	TicketLevel          = EChunkTicketLevel::None;
+	Stage                = EChunkStage::Unloaded;
+	bDirty               = false;
+	bNeedsNeighborNotify = false;
+	bQueuedForRebuild    = false;
+	bDataReady           = false;
+	FaceConnections      = FChunkVisibility::AllConnected;
+	LodLevel             = 0;
+	MeshLodLevel         = 0;
+	bLit                 = false;
+	bHasMesh             = false;
+	bInRegion            = false;
+	PendingUnloadUntil   = 0.0;
+	LastTouchedTime      = 0.0;
+
+	// Keep the array allocation for the next chunk that needs per-voxel storage
+	bUniform       = true;
+	UniformBlockID = 0;
+	FMemory::Memzero(HeightMap, sizeof(HeightMap));
+	Blocks.Reset();
+	ExtraData.Reset();
+	Mesh.Clear();
+	CollisionBoxes.Reset();
+	MaterialToSection.Reset();
+	NextSectionIndex     = 0;
+	TextureArrayMaterial = nullptr;
+	BuildFuture.Reset();
+	WarmData.Reset();
+	SkyLight.Reset();
+	BlockLight.Reset();
+	PendingLightEdits.Reset();
+	ScheduledTicks.Reset();
+}
+
+/// Bytes owned by the holder, used by the world resident memory budget.
+/// FDynamicMesh3 does not report its size so the mesh is estimated per element.
+SIZE_T FChunkHolder::GetAllocatedSize() const
+{
+	constexpr SIZE_T BytesPerVertex   = sizeof(FVector3d) + sizeof(int32) * 2; // Position, ref count, edge list
+	constexpr SIZE_T BytesPerTriangle = sizeof(UE::Geometry::FIndex3i) * 2 + sizeof(int32); // Vertices, edges, group
+	constexpr SIZE_T BytesPerEdge     = sizeof(UE::Geometry::FIndex2i) * 2; // Vertices, triangles
+
+	SIZE_T Size = sizeof(FChunkHolder);
+	Size += Blocks.GetAllocatedSize();
+	Size += ExtraData.GetAllocatedSize();
+	Size += MaterialToSection.GetAllocatedSize();
+	Size += CollisionBoxes.GetAllocatedSize();
+	Size += SkyLight.GetAllocatedSize() + BlockLight.GetAllocatedSize();
+	Size += static_cast<SIZE_T>(Mesh.MaxVertexID()) * BytesPerVertex;
+	Size += static_cast<SIZE_T>(Mesh.MaxTriangleID()) * BytesPerTriangle;
+	Size += static_cast<SIZE_T>(Mesh.MaxEdgeID()) * BytesPerEdge;
+	return Size;
 }
 
 void FChunkHolder::RefreshMaterialCache()
@@ -36,87 +141,260 @@ int32 FChunkHolder::GetSectionIndexForMaterial(UMaterialInterface* InMaterial)
 	return NewIndex;
 }
 
-int32 FChunkHolder::GetBlockIndex(const FIntVector& LocalCoords) const
+/// Section of a block face, one per material. With a texture array material the chunk has
+/// a single section and the face texture is picked by its layer instead
+int32 FChunkHolder::GetFaceSection(const FBlock& Block, EBlockDirection Direction, int32& OutTextureLayer)
 {
-	return LocalCoords.X + LocalCoords.Y * Dimension.X + LocalCoords.Z * Dimension.X * Dimension.Y;
+	if (TextureArrayMaterial)
+	{
+		OutTextureLayer = Block.GetFaceTextureLayer(Direction);
+		return GetSectionIndexForMaterial(TextureArrayMaterial);
+	}
+	OutTextureLayer = INDEX_NONE;
+	return GetSectionIndexForMaterial(Block.GetFacesMaterial(Direction));
 }
 
-FBlock& FChunkHolder::GetBlock(const FIntVector& LocalCoords)
+int32 FChunkHolder::GetBlockIndex(const FIntVector& LocalCoords)
 {
-	return Blocks[GetBlockIndex(LocalCoords)];
+	return FChunkLayout::Index(LocalCoords);
 }
 
-const FBlock& FChunkHolder::GetBlock(const FIntVector& LocalCoords) const
+FBlock FChunkHolder::GetBlock(const FIntVector& LocalCoords) const
 {
-	return Blocks[GetBlockIndex(LocalCoords)];
+	const int32 Index = GetBlockIndex(LocalCoords);
+	FBlock      Block(LocalCoords, ResolveBlockID(GetBlockIDAt(Index)));
+	if (const FBlockExtraData* Extra = ExtraData.Find(Index))
+	{
+		Block.Health        = Extra->Health;
+		Block.BlockStateKey = Extra->BlockStateKey;
+		Block.StateID       = Extra->StateID;
+	}
+	return Block;
+}
+
+void FChunkHolder::SetBlockID(const FIntVector& LocalCoords, uint16 BlockID)
+{
+	// Writing the same block into an uniform chunk does not need the per-voxel array
+	if (bUniform && UniformBlockID == BlockID)
+	{
+		return;
+	}
+	Materialize();
+	Blocks[GetBlockIndex(LocalCoords)] = BlockID;
+
+	// Only the edited column moves, and it only needs a scan when its top block is removed
+	uint8& Height = HeightMap[LocalCoords.X + LocalCoords.Y * FChunkLayout::SizeX];
+	if (IsOpaqueBlockID(BlockID))
+	{
+		Height = FMath::Max<uint8>(Height, LocalCoords.Z + 1);
+	}
+	else if (Height == LocalCoords.Z + 1)
+	{
+		int32 z = LocalCoords.Z - 1;
+		while (z >= 0 && !IsOpaqueBlockID(Blocks[FChunkLayout::Index(LocalCoords.X, LocalCoords.Y, z)]))
+		{
+			--z;
+		}
+		Height = z + 1;
+	}
 }
 
 void FChunkHolder::SetBlock(const FIntVector& LocalCoords, const FBlock& InBlockData)
 {
-	FBlock& Block = GetBlock(LocalCoords);
-	Block         = InBlockData;
+	const uint16 BlockID    = ToBlockID(InBlockData.Definition);
+	const bool   bSameBlock = GetBlockID(LocalCoords) == BlockID;
+	SetBlockID(LocalCoords, BlockID);
+
+	FBlockExtraData Extra;
+	Extra.Health        = InBlockData.Health;
+	Extra.BlockStateKey = InBlockData.BlockStateKey;
+	Extra.StateID       = InBlockData.StateID;
+	// FBlock does not carry the payload, a state change keeps it, a replacement block starts without
+	const FBlockExtraData* Existing = FindExtraData(LocalCoords);
+	if (Existing && bSameBlock)
+	{
+		Extra.Payload = Existing->Payload;
+	}
+	SetExtraData(LocalCoords, Extra);
 }
 
 
 void FChunkHolder::SetBlock(const FIntVector& InCoords, FString Namespace, FString Path)
 {
 	UBlockDefinition* def = UEnigmaRegistrationSubsystem::BLOCK_GET_VALUE(Namespace, Path);
-	SetBlock(InCoords, FBlock(InCoords, def, 100));
+	SetBlock(InCoords, FBlock(InCoords, def, FBlockExtraData::DefaultHealth));
 }
 
-bool FChunkHolder::FillChunkWithArea(FIntVector Area, FString Namespace, FString Path)
+void FChunkHolder::SetExtraData(const FIntVector& LocalCoords, const FBlockExtraData& InExtraData)
 {
-	for (int z = 0; z < Area.Z; ++z)
+	const int32 Index = GetBlockIndex(LocalCoords);
+	if (InExtraData.IsDefault())
+	{
+		ExtraData.Remove(Index);
+		return;
+	}
+	// Uniform meshing uses the default state, a block with its own data needs the per-voxel path
+	Materialize();
+	ExtraData.Add(Index, InExtraData);
+}
+
+/// Turn the whole chunk into a single block without per-voxel storage
+void FChunkHolder::SetUniform(uint16 BlockID)
+{
+	bUniform       = true;
+	UniformBlockID = BlockID;
+	Blocks.Empty();
+	ExtraData.Empty();
+	FMemory::Memset(HeightMap, IsOpaqueBlockID(BlockID) ? FChunkLayout::SizeZ : 0, sizeof(HeightMap));
+}
+
+/// Full scan of every column, top down
+void FChunkHolder::RebuildHeightMap()
+{
+	if (bUniform)
+	{
+		FMemory::Memset(HeightMap, IsOpaqueBlockID(UniformBlockID) ? FChunkLayout::SizeZ : 0, sizeof(HeightMap));
+		return;
+	}
+	for (int32 y = 0; y < FChunkLayout::SizeY; ++y)
 	{
-		for (int y = 0; y < Area.Y; ++y)
+		for (int32 x = 0; x < FChunkLayout::SizeX; ++x)
 		{
-			for (int x = 0; x < Area.X; ++x)
+			int32 z = FChunkLayout::SizeZ - 1;
+			while (z >= 0 && !IsOpaqueBlockID(Blocks[FChunkLayout::Index(x, y, z)]))
 			{
-				SetBlock(FIntVector(x, y, z), Namespace, Path);
+				--z;
 			}
+			HeightMap[x + y * FChunkLayout::SizeX] = static_cast<uint8>(z + 1);
+		}
+	}
+}
+
+bool FChunkHolder::IsOpaqueBlockID(uint16 BlockID)
+{
+	const UBlockDefinition* Definition = ResolveBlockID(BlockID);
+	return Definition && Definition->bIsOpaque;
+}
+
+/// Expand an uniform chunk into the per-voxel array, no-op if already expanded
+void FChunkHolder::Materialize()
+{
+	if (!bUniform)
+	{
+		return;
+	}
+	Blocks.Init(UniformBlockID, GetBlockCount());
+	bUniform = false;
+}
+
+/// Collapse the per-voxel array if every block is the same and none carries extra data
+/// @return whether or not the chunk is uniform after the call
+bool FChunkHolder::TryCompactUniform()
+{
+	if (bUniform)
+	{
+		return true;
+	}
+	if (Blocks.Num() == 0 || ExtraData.Num() > 0)
+	{
+		return false;
+	}
+	const uint16 First = Blocks[0];
+	for (const uint16 BlockID : Blocks)
+	{
+		if (BlockID != First)
+		{
+			return false;
 		}
 	}
+	SetUniform(First);
 	return true;
 }
 
-void FChunkHolder::AddTicket()
+uint16 FChunkHolder::ToBlockID(const UBlockDefinition* Definition)
 {
-	++RefCount;
-	PendingUnloadUntil = 0.0;
+	if (!Definition)
+	{
+		return 0;
+	}
+	checkf(Definition->BlockID > 0 && Definition->BlockID <= MAX_uint16, TEXT("Block %s has no 16 bit block ID"), *Definition->GetName());
+	return static_cast<uint16>(Definition->BlockID);
+}
+
+UBlockDefinition* FChunkHolder::ResolveBlockID(uint16 BlockID)
+{
+	return BlockID == 0 ? nullptr : UEnigmaRegistrationSubsystem::BLOCK_GET_BY_ID(BlockID);
+}
+
+bool FChunkHolder::FillChunkWithArea(FIntVector Area, FString Namespace, FString Path)
+{
+	// Resolve the definition once instead of per voxel
+	UBlockDefinition* def = UEnigmaRegistrationSubsystem::BLOCK_GET_VALUE(Namespace, Path);
 
-	if (Stage == EChunkStage::PendingUnload || Stage == EChunkStage::Unloaded)
+	if (Area.X >= FChunkLayout::SizeX && Area.Y >= FChunkLayout::SizeY && Area.Z >= FChunkLayout::SizeZ)
 	{
-		Stage = EChunkStage::Loading;
+		SetUniform(ToBlockID(def));
+		return true;
+	}
+
+	for (int z = 0; z < FMath::Min(Area.Z, FChunkLayout::SizeZ); ++z)
+	{
+		for (int y = 0; y < FMath::Min(Area.Y, FChunkLayout::SizeY); ++y)
+		{
+			for (int x = 0; x < FMath::Min(Area.X, FChunkLayout::SizeX); ++x)
+			{
+				SetBlockID(FIntVector(x, y, z), ToBlockID(def));
+			}
+		}
 	}
+	return true;
 }
 
-void FChunkHolder::RemoveTicket(double Now, double Grace)
+void FChunkHolder::SetTicketLevel(EChunkTicketLevel Level, double Now, double Grace)
 {
-	if (RefCount == 0)
+	const EChunkTicketLevel Previous = TicketLevel.exchange(Level);
+	if (Level == EChunkTicketLevel::None)
 	{
+		if (Previous != EChunkTicketLevel::None)
+		{
+			Stage              = EChunkStage::PendingUnload;
+			PendingUnloadUntil = Now + Grace;
+			LastTouchedTime    = Now;
+		}
 		return;
 	}
-	check(RefCount>0)
-	--RefCount;
-	if (RefCount == 0)
+
+	PendingUnloadUntil = 0.0;
+	if (Stage == EChunkStage::Unloaded)
+	{
+		Stage = EChunkStage::Loading;
+	}
+	else if (Stage == EChunkStage::PendingUnload)
 	{
-		Stage              = EChunkStage::PendingUnload;
-		PendingUnloadUntil = Now + Grace;
+		// Still resident, hand the existing mesh back to the actor instead of regenerating
+		Stage = bDataReady ? EChunkStage::Ready : EChunkStage::Loading;
 	}
 }
 
+void FChunkHolder::DropMesh()
+{
+	Mesh.Clear();
+	CollisionBoxes.Reset();
+	bHasMesh = false;
+}
+
 bool IsFaceVisibleInChunkData(const FChunkHolder& ChunkHolder, int x, int y, int z, EBlockDirection Direction)
 {
 	FIntVector3 blockPos(x, y, z);
 	switch (Direction)
 	{
 	case EBlockDirection::NORTH:
-		if (blockPos.X + 1 >= ChunkHolder.Dimension.X)
+		if (blockPos.X + 1 >= FChunkLayout::SizeX)
 		{
 			return true;
 		}
 		blockPos.X += 1;
-		if (ChunkHolder.GetBlock(blockPos).Definition == nullptr)
+		if (ChunkHolder.GetBlockID(blockPos) == 0)
 		{
 			return true;
 		}
@@ -127,18 +405,18 @@ bool IsFaceVisibleInChunkData(const FChunkHolder& ChunkHolder, int x, int y, int
 			return true;
 		}
 		blockPos.X -= 1;
-		if (ChunkHolder.GetBlock(blockPos).Definition == nullptr)
+		if (ChunkHolder.GetBlockID(blockPos) == 0)
 		{
 			return true;
 		}
 		return false;
 	case EBlockDirection::EAST:
-		if (blockPos.Y + 1 >= ChunkHolder.Dimension.Y)
+		if (blockPos.Y + 1 >= FChunkLayout::SizeY)
 		{
 			return true;
 		}
 		blockPos.Y += 1;
-		if (ChunkHolder.GetBlock(blockPos).Definition == nullptr)
+		if (ChunkHolder.GetBlockID(blockPos) == 0)
 		{
 			return true;
 		}
@@ -149,18 +427,18 @@ bool IsFaceVisibleInChunkData(const FChunkHolder& ChunkHolder, int x, int y, int
 			return true;
 		}
 		blockPos.Y -= 1;
-		if (ChunkHolder.GetBlock(blockPos).Definition == nullptr)
+		if (ChunkHolder.GetBlockID(blockPos) == 0)
 		{
 			return true;
 		}
 		return false;
 	case EBlockDirection::UP:
-		if (blockPos.Z + 1 >= ChunkHolder.Dimension.Z)
+		if (blockPos.Z + 1 >= FChunkLayout::SizeZ)
 		{
 			return true;
 		}
 		blockPos.Z += 1;
-		if (ChunkHolder.GetBlock(blockPos).Definition == nullptr)
+		if (ChunkHolder.GetBlockID(blockPos) == 0)
 		{
 			return true;
 		}
@@ -171,7 +449,7 @@ bool IsFaceVisibleInChunkData(const FChunkHolder& ChunkHolder, int x, int y, int
 			return true;
 		}
 		blockPos.Z -= 1;
-		if (ChunkHolder.GetBlock(blockPos).Definition == nullptr)
+		if (ChunkHolder.GetBlockID(blockPos) == 0)
 		{
 			return true;
 		}
@@ -182,14 +460,11 @@ bool IsFaceVisibleInChunkData(const FChunkHolder& ChunkHolder, int x, int y, int
 
 bool IsFaceVisible(UEnigmaWorld* World, const FChunkHolder& ChunkHolder, int x, int y, int z, EBlockDirection Direction)
 {
-	const FIntVector& Dim = ChunkHolder.Dimension;
-	// ap the local coordinates (x, y, z) in the current block to the global block coordinates (block-based)
+	// Map the local coordinates (x, y, z) in the current chunk to the global block coordinates (block-based)
+	const FIntVector ChunkBlockOrigin = FVoxelCoords::ChunkToBlock(ChunkHolder.Coords);
 	auto GetGlobalBlockCoords = [&](int LocalX, int LocalY, int LocalZ)
 	{
-		int GlobalX = ChunkHolder.Coords.X * Dim.X + LocalX;
-		int GlobalY = ChunkHolder.Coords.Y * Dim.Y + LocalY;
-		int GlobalZ = ChunkHolder.Coords.Z * Dim.Z + LocalZ;
-		return FIntVector(GlobalX, GlobalY, GlobalZ);
+		return ChunkBlockOrigin + FIntVector(LocalX, LocalY, LocalZ);
 	};
 
 	switch (Direction)
@@ -198,7 +473,7 @@ bool IsFaceVisible(UEnigmaWorld* World, const FChunkHolder& ChunkHolder, int x,
 	case EBlockDirection::NORTH:
 		{
 			// Determine whether to cross the X range of this Chunk
-			if (x + 1 >= Dim.X)
+			if (x + 1 >= FChunkLayout::SizeX)
 			{
 				FIntVector        neighborGlobalPos = GetGlobalBlockCoords(x + 1, y, z);
 				UBlockDefinition* neighborDef       = World->GetBlockAtBlockPos(neighborGlobalPos);
@@ -206,7 +481,7 @@ bool IsFaceVisible(UEnigmaWorld* World, const FChunkHolder& ChunkHolder, int x,
 				return (neighborDef == nullptr);
 			}
 			// Inside this Chunk => directly look at the adjacent blocks
-			if (ChunkHolder.GetBlock(FIntVector(x + 1, y, z)).Definition == nullptr)
+			if (ChunkHolder.GetBlockID(FIntVector(x + 1, y, z)) == 0)
 			{
 				return true; // air => visible
 			}
@@ -224,7 +499,7 @@ bool IsFaceVisible(UEnigmaWorld* World, const FChunkHolder& ChunkHolder, int x,
 				return (neighborDef == nullptr);
 			}
 			// 本 Chunk
-			if (ChunkHolder.GetBlock(FIntVector(x - 1, y, z)).Definition == nullptr)
+			if (ChunkHolder.GetBlockID(FIntVector(x - 1, y, z)) == 0)
 			{
 				return true;
 			}
@@ -234,13 +509,13 @@ bool IsFaceVisible(UEnigmaWorld* World, const FChunkHolder& ChunkHolder, int x,
 	// +Y
 	case EBlockDirection::EAST:
 		{
-			if (y + 1 >= Dim.Y)
+			if (y + 1 >= FChunkLayout::SizeY)
 			{
 				FIntVector        neighborGlobalPos = GetGlobalBlockCoords(x, y + 1, z);
 				UBlockDefinition* neighborDef       = World->GetBlockAtBlockPos(neighborGlobalPos);
 				return (neighborDef == nullptr);
 			}
-			if (ChunkHolder.GetBlock(FIntVector(x, y + 1, z)).Definition == nullptr)
+			if (ChunkHolder.GetBlockID(FIntVector(x, y + 1, z)) == 0)
 			{
 				return true;
 			}
@@ -256,7 +531,7 @@ bool IsFaceVisible(UEnigmaWorld* World, const FChunkHolder& ChunkHolder, int x,
 				UBlockDefinition* neighborDef       = World->GetBlockAtBlockPos(neighborGlobalPos);
 				return (neighborDef == nullptr);
 			}
-			if (ChunkHolder.GetBlock(FIntVector(x, y - 1, z)).Definition == nullptr)
+			if (ChunkHolder.GetBlockID(FIntVector(x, y - 1, z)) == 0)
 			{
 				return true;
 			}
@@ -266,13 +541,13 @@ bool IsFaceVisible(UEnigmaWorld* World, const FChunkHolder& ChunkHolder, int x,
 	// +Z
 	case EBlockDirection::UP:
 		{
-			if (z + 1 >= Dim.Z)
+			if (z + 1 >= FChunkLayout::SizeZ)
 			{
 				FIntVector        neighborGlobalPos = GetGlobalBlockCoords(x, y, z + 1);
 				UBlockDefinition* neighborDef       = World->GetBlockAtBlockPos(neighborGlobalPos);
 				return (neighborDef == nullptr);
 			}
-			if (ChunkHolder.GetBlock(FIntVector(x, y, z + 1)).Definition == nullptr)
+			if (ChunkHolder.GetBlockID(FIntVector(x, y, z + 1)) == 0)
 			{
 				return true;
 			}
@@ -288,7 +563,7 @@ bool IsFaceVisible(UEnigmaWorld* World, const FChunkHolder& ChunkHolder, int x,
 				UBlockDefinition* neighborDef       = World->GetBlockAtBlockPos(neighborGlobalPos);
 				return (neighborDef == nullptr);
 			}
-			if (ChunkHolder.GetBlock(FIntVector(x, y, z - 1)).Definition == nullptr)
+			if (ChunkHolder.GetBlockID(FIntVector(x, y, z - 1)) == 0)
 			{
 				return true;
 			}
@@ -299,137 +574,93 @@ bool IsFaceVisible(UEnigmaWorld* World, const FChunkHolder& ChunkHolder, int x,
 	}
 }
 
-void AppendBoxForBlock(FDynamicMesh3& Mesh, const FBlock& Block, FChunkHolder& ChunkHolder)
+FIntVector GetFaceNormal(EBlockDirection Direction)
 {
-	const FIntVector blockPos = Block.Coordinates;
-	// Calculate the coordinates of each block in the world
-	float   BlockSize = ChunkHolder.BlockSize;
-	FVector blockMinPt(static_cast<float>(blockPos.X) * BlockSize, static_cast<float>(blockPos.Y) * BlockSize, static_cast<float>(blockPos.Z) * BlockSize);
-	FVector blockMaxPt(blockMinPt.X + BlockSize, blockMinPt.Y + BlockSize, blockMinPt.Z + BlockSize);
-
-	// Add 8 vertices
-	int32 v0 = Mesh.AppendVertex(FVector3d(blockMaxPt.X, blockMinPt.Y, blockMinPt.Z));
-	int32 v1 = Mesh.AppendVertex(FVector3d(blockMaxPt.X, blockMaxPt.Y, blockMinPt.Z));
-	int32 v2 = Mesh.AppendVertex(FVector3d(blockMaxPt.X, blockMaxPt.Y, blockMaxPt.Z));
-	int32 v3 = Mesh.AppendVertex(FVector3d(blockMaxPt.X, blockMinPt.Y, blockMaxPt.Z));
-	int32 v4 = Mesh.AppendVertex(FVector3d(blockMinPt.X, blockMaxPt.Y, blockMinPt.Z));
-	int32 v5 = Mesh.AppendVertex(FVector3d(blockMinPt.X, blockMinPt.Y, blockMinPt.Z));
-	int32 v6 = Mesh.AppendVertex(FVector3d(blockMinPt.X, blockMinPt.Y, blockMaxPt.Z));
-	int32 v7 = Mesh.AppendVertex(FVector3d(blockMinPt.X, blockMaxPt.Y, blockMaxPt.Z));
-
-	// +X faces => EBlockDirection::NORTH
-	if (IsFaceVisibleInChunkData(ChunkHolder, blockPos.X, blockPos.Y, blockPos.Z, EBlockDirection::NORTH))
-	{
-		int sectionID = ChunkHolder.GetSectionIndexForMaterial(Block.GetFacesMaterial(EBlockDirection::NORTH));
-		Mesh.AppendTriangle(v1, v0, v3, sectionID);
-		Mesh.AppendTriangle(v1, v3, v2, sectionID);
-	}
-
-	// -X faces => EBlockDirection::SOUTH
-	if (IsFaceVisibleInChunkData(ChunkHolder, blockPos.X, blockPos.Y, blockPos.Z, EBlockDirection::SOUTH))
-	{
-		int sectionID = ChunkHolder.GetSectionIndexForMaterial(Block.GetFacesMaterial(EBlockDirection::SOUTH));
-		Mesh.AppendTriangle(v5, v4, v7, sectionID);
-		Mesh.AppendTriangle(v5, v7, v6, sectionID);
-	}
-
-	// +Y faces => EBlockDirection::EAST
-	if (IsFaceVisibleInChunkData(ChunkHolder, blockPos.X, blockPos.Y, blockPos.Z, EBlockDirection::EAST))
-	{
-		int sectionID = ChunkHolder.GetSectionIndexForMaterial(Block.GetFacesMaterial(EBlockDirection::EAST));
-		Mesh.AppendTriangle(v4, v1, v2, sectionID);
-		Mesh.AppendTriangle(v4, v2, v7, sectionID);
-	}
-
-	// -Y faces => EBlockDirection::WEST
-	if (IsFaceVisibleInChunkData(ChunkHolder, blockPos.X, blockPos.Y, blockPos.Z, EBlockDirection::WEST))
-	{
-		int sectionID = ChunkHolder.GetSectionIndexForMaterial(Block.GetFacesMaterial(EBlockDirection::WEST));
-		Mesh.AppendTriangle(v0, v5, v6, sectionID);
-		Mesh.AppendTriangle(v0, v6, v3, sectionID);
-	}
-
-	// -Z faces => EBlockDirection::DOWN
-	if (IsFaceVisibleInChunkData(ChunkHolder, blockPos.X, blockPos.Y, blockPos.Z, EBlockDirection::DOWN))
-	{
-		int sectionID = ChunkHolder.GetSectionIndexForMaterial(Block.GetFacesMaterial(EBlockDirection::DOWN));
-		Mesh.AppendTriangle(v5, v0, v1, sectionID);
-		Mesh.AppendTriangle(v5, v1, v4, sectionID);
-	}
+	return FaceOffsets[static_cast<uint8>(Direction)];
+}
 
-	// +Z faces => EBlockDirection::UP
-	if (IsFaceVisibleInChunkData(ChunkHolder, blockPos.X, blockPos.Y, blockPos.Z, EBlockDirection::UP))
-	{
-		UMaterialInterface* material  = Block.GetFacesMaterial(EBlockDirection::UP);
-		int                 sectionID = ChunkHolder.GetSectionIndexForMaterial(material);
-		Mesh.AppendTriangle(v2, v3, v6, sectionID);
-		Mesh.AppendTriangle(v2, v6, v7, sectionID);
-	}
+FIntVector GetFaceCorner(EBlockDirection Direction, int32 Corner)
+{
+	return CubeCorners[FaceCorners[static_cast<uint8>(Direction)][Corner]];
 }
 
-void AppendBoxForBlock(UEnigmaWorld* World, FDynamicMesh3& Mesh, const FBlock& Block, FChunkHolder& ChunkHolder)
+/// Append a single block face, open to the sky (no ambient occlusion)
+void AppendFaceForBlock(FDynamicMesh3& Mesh, const FIntVector& LocalCoords, EBlockDirection Direction, int32 SectionID, float BlockSize, int32 TextureLayer)
 {
-	const FIntVector blockPos = Block.Coordinates;
-	// Calculate the diagonal point of the block in the world
-	float   BlockSize = ChunkHolder.BlockSize;
-	FVector blockMinPt(static_cast<float>(blockPos.X) * BlockSize, static_cast<float>(blockPos.Y) * BlockSize, static_cast<float>(blockPos.Z) * BlockSize);
-	FVector blockMaxPt(blockMinPt.X + BlockSize, blockMinPt.Y + BlockSize, blockMinPt.Z + BlockSize);
-
-	int32 v0 = Mesh.AppendVertex(FVector3d(blockMaxPt.X, blockMinPt.Y, blockMinPt.Z));
-	int32 v1 = Mesh.AppendVertex(FVector3d(blockMaxPt.X, blockMaxPt.Y, blockMinPt.Z));
-	int32 v2 = Mesh.AppendVertex(FVector3d(blockMaxPt.X, blockMaxPt.Y, blockMaxPt.Z));
-	int32 v3 = Mesh.AppendVertex(FVector3d(blockMaxPt.X, blockMinPt.Y, blockMaxPt.Z));
-	int32 v4 = Mesh.AppendVertex(FVector3d(blockMinPt.X, blockMaxPt.Y, blockMinPt.Z));
-	int32 v5 = Mesh.AppendVertex(FVector3d(blockMinPt.X, blockMinPt.Y, blockMinPt.Z));
-	int32 v6 = Mesh.AppendVertex(FVector3d(blockMinPt.X, blockMinPt.Y, blockMaxPt.Z));
-	int32 v7 = Mesh.AppendVertex(FVector3d(blockMinPt.X, blockMaxPt.Y, blockMaxPt.Z));
-
-	// +X => EBlockDirection::NORTH
-	if (IsFaceVisible(World, ChunkHolder, blockPos.X, blockPos.Y, blockPos.Z, EBlockDirection::NORTH))
-	{
-		int sectionID = ChunkHolder.GetSectionIndexForMaterial(Block.GetFacesMaterial(EBlockDirection::NORTH));
-		Mesh.AppendTriangle(v1, v0, v3, sectionID);
-		Mesh.AppendTriangle(v1, v3, v2, sectionID);
-	}
+	static constexpr uint8 OpenAO[4] = {3, 3, 3, 3};
+	AppendQuadForFace(Mesh, LocalCoords, FIntVector(1), Direction, SectionID, BlockSize, TextureLayer, OpenAO);
+}
 
-	// -X => EBlockDirection::SOUTH
-	if (IsFaceVisible(World, ChunkHolder, blockPos.X, blockPos.Y, blockPos.Z, EBlockDirection::SOUTH))
+/// Append the 4 vertices and 2 triangles of a face covering Extent blocks (1 along the face
+/// normal). Vertex colour red is the corner ambient occlusion (AO / 3), green the texture array
+/// layer (Layer / 255, 0 without texture array) and blue the voxel light in front of the face
+/// (Light / 15). UVs count blocks so textures repeat on a merged face
+/// @param CornerAO Per corner occlusion, 0 fully occluded to 3 open, in face corner order
+/// @param LightLevel Brightest of the sky and block light in front of the face (FChunkLight)
+void AppendQuadForFace(FDynamicMesh3& Mesh, const FIntVector& LocalCoords, const FIntVector& Extent, EBlockDirection Direction, int32 SectionID, float BlockSize, int32 TextureLayer, const uint8 CornerAO[4], uint8 LightLevel)
+{
+	if (!Mesh.HasVertexColors())
 	{
-		int sectionID = ChunkHolder.GetSectionIndexForMaterial(Block.GetFacesMaterial(EBlockDirection::SOUTH));
-		Mesh.AppendTriangle(v5, v4, v7, sectionID);
-		Mesh.AppendTriangle(v5, v7, v6, sectionID);
+		Mesh.EnableVertexColors(FVector3f::One());
+		Mesh.EnableVertexUVs(FVector2f::Zero());
 	}
 
-	// +Y => EBlockDirection::EAST
-	if (IsFaceVisible(World, ChunkHolder, blockPos.X, blockPos.Y, blockPos.Z, EBlockDirection::EAST))
+	const uint8  Face    = static_cast<uint8>(Direction);
+	const int32* Corners = FaceCorners[Face];
+	const float  Layer   = TextureLayer == INDEX_NONE ? 0.f : FMath::Clamp(TextureLayer, 0, 255) / 255.f;
+	const float  ScaleU  = Extent[FaceUVAxes[Face][0]];
+	const float  ScaleV  = Extent[FaceUVAxes[Face][1]];
+	const float  Light   = FMath::Min<uint8>(LightLevel, 15) / 15.f;
+	int32        V[4];
+	for (int32 i = 0; i < 4; ++i)
 	{
-		int sectionID = ChunkHolder.GetSectionIndexForMaterial(Block.GetFacesMaterial(EBlockDirection::EAST));
-		Mesh.AppendTriangle(v4, v1, v2, sectionID);
-		Mesh.AppendTriangle(v4, v2, v7, sectionID);
+		const FIntVector          Corner = CubeCorners[Corners[i]];
+		const FIntVector          P      = LocalCoords + FIntVector(Corner.X * Extent.X, Corner.Y * Extent.Y, Corner.Z * Extent.Z);
+		UE::Geometry::FVertexInfo Vertex(FVector3d(P.X * BlockSize, P.Y * BlockSize, P.Z * BlockSize));
+		Vertex.bHaveC  = true;
+		Vertex.Color   = FVector3f(CornerAO[i] / 3.f, Layer, Light);
+		Vertex.bHaveUV = true;
+		Vertex.UV      = FVector2f(FaceUVs[i].X * ScaleU, FaceUVs[i].Y * ScaleV);
+		V[i]           = Mesh.AppendVertex(Vertex);
 	}
 
-	// -Y => EBlockDirection::WEST
-	if (IsFaceVisible(World, ChunkHolder, blockPos.X, blockPos.Y, blockPos.Z, EBlockDirection::WEST))
+	// Split along the diagonal joining the brighter corners, the AO gradient stays symmetric
+	if (CornerAO[1] + CornerAO[3] > CornerAO[0] + CornerAO[2])
 	{
-		int sectionID = ChunkHolder.GetSectionIndexForMaterial(Block.GetFacesMaterial(EBlockDirection::WEST));
-		Mesh.AppendTriangle(v0, v5, v6, sectionID);
-		Mesh.AppendTriangle(v0, v6, v3, sectionID);
+		Mesh.AppendTriangle(V[1], V[2], V[3], SectionID);
+		Mesh.AppendTriangle(V[1], V[3], V[0], SectionID);
+		return;
 	}
+	Mesh.AppendTriangle(V[0], V[1], V[2], SectionID);
+	Mesh.AppendTriangle(V[0], V[2], V[3], SectionID);
+}
 
-	// -Z => EBlockDirection::DOWN
-	if (IsFaceVisible(World, ChunkHolder, blockPos.X, blockPos.Y, blockPos.Z, EBlockDirection::DOWN))
+/// Append the visible faces of the block, faces on the chunk border are always
+/// visible since only the chunk own data is read
+void AppendBoxForBlock(FDynamicMesh3& Mesh, const FIntVector& LocalCoords, const FBlock& Block, FChunkHolder& ChunkHolder)
+{
+	for (EBlockDirection Direction : AllDirections)
 	{
-		int sectionID = ChunkHolder.GetSectionIndexForMaterial(Block.GetFacesMaterial(EBlockDirection::DOWN));
-		Mesh.AppendTriangle(v5, v0, v1, sectionID);
-		Mesh.AppendTriangle(v5, v1, v4, sectionID);
+		if (IsFaceVisibleInChunkData(ChunkHolder, LocalCoords.X, LocalCoords.Y, LocalCoords.Z, Direction))
+		{
+			int textureLayer;
+			int sectionID = ChunkHolder.GetFaceSection(Block, Direction, textureLayer);
+			AppendFaceForBlock(Mesh, LocalCoords, Direction, sectionID, ChunkHolder.BlockSize, textureLayer);
+		}
 	}
+}
 
-	// +Z => EBlockDirection::UP
-	if (IsFaceVisible(World, ChunkHolder, blockPos.X, blockPos.Y, blockPos.Z, EBlockDirection::UP))
+/// Append the visible faces of the block, faces on the chunk border query the
+/// neighbour chunk through the world
+void AppendBoxForBlock(UEnigmaWorld* World, FDynamicMesh3& Mesh, const FIntVector& LocalCoords, const FBlock& Block, FChunkHolder& ChunkHolder)
+{
+	for (EBlockDirection Direction : AllDirections)
 	{
-		UMaterialInterface* tempMaterial = Block.GetFacesMaterial(EBlockDirection::UP);
-		int                 sectionID    = ChunkHolder.GetSectionIndexForMaterial(tempMaterial);
-		Mesh.AppendTriangle(v2, v3, v6, sectionID);
-		Mesh.AppendTriangle(v2, v6, v7, sectionID);
+		if (IsFaceVisible(World, ChunkHolder, LocalCoords.X, LocalCoords.Y, LocalCoords.Z, Direction))
+		{
+			int textureLayer;
+			int sectionID = ChunkHolder.GetFaceSection(Block, Direction, textureLayer);
+			AppendFaceForBlock(Mesh, LocalCoords, Direction, sectionID, ChunkHolder.BlockSize, textureLayer);
+		}
 	}
 }
@@ -3,30 +3,45 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "ChunkLayout.h"
+#include "ChunkVisibility.h"
 #include "DynamicMesh/DynamicMesh3.h"
+#include "EnigmaVoxel/Modules/Block/Block.h"
+#include "EnigmaVoxel/Modules/Block/BlockTick.h"
 #include "UObject/Object.h"
 #include "ChunkHolder.generated.h"
 
 enum class EBlockDirection : uint8;
 class UEnigmaWorld;
-struct FBlock;
+struct FCompressedChunk;
 
 UENUM()
 enum class EChunkStage : uint8
 {
 	Unloaded, // No data in memory
 	Loading, // Thread pool is generating full blocks + grids meshes
-	Ready, // The Mesh has been constructed, but has not yet been copied into the Actor
+	Ready, // The Mesh has been constructed, but has not yet been copied into the Actor. Chunks below Render stay here without mesh
 	Loaded, // Mesh has been synchronized to Actor, and the block is active
-	PendingUnload // Reference count = 0, waiting for the grace period to end before being destroyed
+	PendingUnload // No ticket, data stay resident until the world memory budget evicts it (LRU)
 };
 
 UENUM()
 enum class ETicketType : uint8
 {
-	Player,
-	Entity,
-	Forced
+	Player, // Controlled pawn, the only source of rendered chunks
+	Entity, // Pawn registered with UEnigmaWorld::AddEntity, simulated around it
+	Forced // Chunk kept simulated without anyone near (farms, spawn area)
+};
+
+/// What a ticketed chunk costs, strongest first. A source gives its chunks a level from
+/// their distance to it, ring after ring, and a chunk keeps the strongest level it gets
+UENUM()
+enum class EChunkTicketLevel : uint8
+{
+	Render, // Meshed, uploaded to an actor or region cluster, simulated
+	Simulate, // Block ticks and light, no mesh nor actor
+	DataOnly, // Blocks and light only, neighbours of the simulated chunks read them
+	None // No ticket, PendingUnload until evicted
 };
 
 /**
@@ -46,39 +61,104 @@ struct FChunkHolder
 	FIntVector Coords = FIntVector::ZeroValue;
 
 	/// Running State
-	std::atomic<uint16>      RefCount{0};
-	std::atomic<EChunkStage> Stage{EChunkStage::Unloaded};
-	std::atomic<bool>        bDirty{false};
-	std::atomic<bool>        bNeedsNeighborNotify{false};
-	std::atomic<bool>        bQueuedForRebuild{false};
-	double                   PendingUnloadUntil = 0.0; // 0 == Not queued for unloading
+	std::atomic<EChunkTicketLevel> TicketLevel{EChunkTicketLevel::None};
+	std::atomic<EChunkStage>       Stage{EChunkStage::Unloaded};
+	std::atomic<bool>              bDirty{false};
+	std::atomic<bool>              bNeedsNeighborNotify{false};
+	std::atomic<bool>              bQueuedForRebuild{false};
+	std::atomic<bool>              bDataReady{false}; // Blocks are generated, a re-ticket does not need the generator
+	std::atomic<uint64>            FaceConnections{FChunkVisibility::AllConnected}; // Occlusion graph, written by the mesher
+	std::atomic<uint8>             LodLevel{0}; // Wanted mesh detail (FChunkLod), picked by the world from the ticket distance
+	std::atomic<uint8>             MeshLodLevel{0}; // Level the current Mesh was built at, written by the mesher
+	std::atomic<bool>              bLit{false}; // First light stage done, the mesher reads full sky before
+	std::atomic<bool>              bHasMesh{false}; // Mesh and collision match the blocks, chunks below Render skip meshing
+	std::atomic<uint8>             LightStageCount{0}; // Running light stages whose 3x3 neighbourhood holds the chunk, never evicted meanwhile
+	bool                           bInRegion          = false; // Drawn by its region cluster instead of a chunk actor, game thread only
+	double                         PendingUnloadUntil = 0.0; // 0 == Not queued for unloading, when the render actor is released
+	double                         LastTouchedTime    = 0.0; // Last time the chunk lost its ticket, LRU key for eviction
 
 	/// Data
-	FIntVector                       Dimension{16, 16, 16};
-	float                            BlockSize = 100.f;
-	TArray<FBlock>                   Blocks;
+	/// Voxels are stored as global block IDs (UBlockDefinition::BlockID, 0 is air), anything else
+	/// lives in the sparse ExtraData map. A uniform chunk (all air, all stone...) only stores
+	/// UniformBlockID and keep Blocks empty, the per-voxel array is only allocated once a
+	/// different block is written. Dimensions are the compile-time FChunkLayout, indexed with shifts.
+	float                            BlockSize      = 100.f;
+	bool                             bUniform       = true;
+	uint16                           UniformBlockID = 0;
+	TArray<uint16>                   Blocks;
+	TMap<int32, FBlockExtraData>     ExtraData; // Keyed by block index, only blocks that differ from the defaults
+	uint8                            HeightMap[FChunkLayout::SizeX * FChunkLayout::SizeY] = {}; // Per column Z + 1 of the topmost opaque block, 0 if none
 	UE::Geometry::FDynamicMesh3      Mesh;
+	TArray<FBox>                     CollisionBoxes; // Merged solid voxels in local space, built with the mesh
 	TMap<UMaterialInterface*, int32> MaterialToSection;
-	int32                            NextSectionIndex = 0;
+	int32                            NextSectionIndex     = 0;
+	UMaterialInterface*              TextureArrayMaterial = nullptr; // Set by the world, every face goes in its single section
 	TSharedPtr<TFuture<void>>        BuildFuture;
+	TSharedPtr<FCompressedChunk>     WarmData; // Taken from the warm cache, restored by the worker instead of generated
+
+	/// Light
+	/// Two 4-bit levels per byte (FChunkLight), allocated by the game thread before the first light
+	/// stage of the chunk. Edits are queued by the game thread and consumed by the next light stage.
+	TArray<uint8>      SkyLight;
+	TArray<uint8>      BlockLight;
+	TArray<FIntVector> PendingLightEdits; // Local coords, game thread only
+
+	/// Simulation
+	TArray<FScheduledBlockTick> ScheduledTicks; // Heap, earliest first. Game thread, or the chunk tick task during a batch
+
+	/// Most chunks only use a handful of materials
+	static constexpr int32 ExpectedMaterialCount = 8;
+	static_assert(FChunkLayout::SizeZ < 256, "HeightMap stores a column height in a byte");
 
 	/// API
+	void          ResetForReuse();
+	SIZE_T        GetAllocatedSize() const;
 	void          RefreshMaterialCache();
 	int32         GetSectionIndexForMaterial(UMaterialInterface*);
-	int32         GetBlockIndex(const FIntVector& LocalCoords) const;
-	FBlock&       GetBlock(const FIntVector& LocalCoords);
-	const FBlock& GetBlock(const FIntVector& LocalCoords) const;
+	int32         GetFaceSection(const FBlock& Block, EBlockDirection Direction, int32& OutTextureLayer); // Layer is INDEX_NONE without texture array
+	static int32  GetBlockCount() { return FChunkLayout::Count; }
+	static int32  GetBlockIndex(const FIntVector& LocalCoords);
+	uint16        GetBlockID(const FIntVector& LocalCoords) const { return GetBlockIDAt(GetBlockIndex(LocalCoords)); }
+	uint16        GetBlockIDAt(int32 Index) const { return bUniform ? UniformBlockID : Blocks[Index]; }
+	FBlock        GetBlock(const FIntVector& LocalCoords) const; // Resolve the definition and the extra data
+	void          SetBlockID(const FIntVector& LocalCoords, uint16 BlockID); // Keep the extra data, update the height map
 	void          SetBlock(const FIntVector& LocalCoords, const FBlock& InBlockData);
 	void          SetBlock(const FIntVector& InCoords, FString Namespace = "Enigma", FString Path = "");
 
+	// Sparse Extra Data
+	const FBlockExtraData* FindExtraData(const FIntVector& LocalCoords) const { return ExtraData.Find(GetBlockIndex(LocalCoords)); }
+	void                   SetExtraData(const FIntVector& LocalCoords, const FBlockExtraData& InExtraData); // Default data remove the entry
+
+	// Height Map
+	int32 GetColumnHeight(int32 X, int32 Y) const { return HeightMap[X + Y * FChunkLayout::SizeX]; } // Lowest Z with only open blocks above
+	void  RebuildHeightMap(); // After writing Blocks directly
+	static bool IsOpaqueBlockID(uint16 BlockID); // Stops the sky light, the definition is bIsOpaque
+
+	// Uniform Storage
+	bool IsUniform() const { return bUniform; }
+	bool IsEmpty() const { return bUniform && UniformBlockID == 0; }
+	void SetUniform(uint16 BlockID);
+	void Materialize();
+	bool TryCompactUniform();
+
+	static uint16            ToBlockID(const UBlockDefinition* Definition);
+	static UBlockDefinition* ResolveBlockID(uint16 BlockID);
+
 	bool FillChunkWithArea(FIntVector Area, FString Namespace = "Enigma", FString Path = "");
 
 	// Ticket
-	void AddTicket();
-	void RemoveTicket(double Now, double Grace);
+	void SetTicketLevel(EChunkTicketLevel Level, double Now, double Grace); // None starts the unload grace period
+	bool HasTicket() const { return TicketLevel != EChunkTicketLevel::None; }
+	bool IsRendered() const { return TicketLevel == EChunkTicketLevel::Render; }
+	bool IsSimulated() const { return TicketLevel <= EChunkTicketLevel::Simulate; }
+	void DropMesh(); // Free the mesh and collision of a chunk that is no longer rendered
 };
 
 bool IsFaceVisibleInChunkData(const FChunkHolder& ChunkHolder, int x, int y, int z, EBlockDirection Direction);
 bool IsFaceVisible(UEnigmaWorld* World, const FChunkHolder& ChunkHolder, int x, int y, int z, EBlockDirection Direction);
-void AppendBoxForBlock(UE::Geometry::FDynamicMesh3& Mesh, const FBlock& Block, FChunkHolder& ChunkHolder);
-void AppendBoxForBlock(UEnigmaWorld* World, UE::Geometry::FDynamicMesh3& Mesh, const FBlock& Block, FChunkHolder& ChunkHolder);
+FIntVector GetFaceNormal(EBlockDirection Direction);
+FIntVector GetFaceCorner(EBlockDirection Direction, int32 Corner); // Unit cube corner, in the vertex order of the face
+void AppendFaceForBlock(UE::Geometry::FDynamicMesh3& Mesh, const FIntVector& LocalCoords, EBlockDirection Direction, int32 SectionID, float BlockSize, int32 TextureLayer = INDEX_NONE);
+void AppendQuadForFace(UE::Geometry::FDynamicMesh3& Mesh, const FIntVector& LocalCoords, const FIntVector& Extent, EBlockDirection Direction, int32 SectionID, float BlockSize, int32 TextureLayer, const uint8 CornerAO[4], uint8 LightLevel = 15); // LightLevel 0 to 15
+void AppendBoxForBlock(UE::Geometry::FDynamicMesh3& Mesh, const FIntVector& LocalCoords, const FBlock& Block, FChunkHolder& ChunkHolder);
+void AppendBoxForBlock(UEnigmaWorld* World, UE::Geometry::FDynamicMesh3& Mesh, const FIntVector& LocalCoords, const FBlock& Block, FChunkHolder& ChunkHolder);
@@ -0,0 +1,48 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ChunkHolderPool.h"
+#include "ChunkHolder.h"
+#include "EnigmaVoxel/Core/Log/DefinedLog.h"
+
+FChunkHolderPool::FChunkHolderPool(int32 InSlabSize)
+	: SlabSize(FMath::Max(1, InSlabSize))
+{
+}
+
+FChunkHolderPool::~FChunkHolderPool()
+{
+	FreeList.Empty();
+	Slabs.Empty();
+}
+
+FChunkHolder* FChunkHolderPool::Acquire()
+{
+	if (FreeList.Num() == 0)
+	{
+		AllocateSlab();
+	}
+	return FreeList.Pop(EAllowShrinking::No);
+}
+
+void FChunkHolderPool::Release(FChunkHolder* Holder)
+{
+	if (!Holder)
+	{
+		return;
+	}
+	Holder->ResetForReuse();
+	FreeList.Add(Holder);
+}
+
+void FChunkHolderPool::AllocateSlab()
+{
+	TUniquePtr<FChunkHolder[]> Slab = MakeUnique<FChunkHolder[]>(SlabSize);
+	FreeList.Reserve(FreeList.Num() + SlabSize);
+	// Push in reverse so Acquire hands out the slab from the front
+	for (int32 i = SlabSize - 1; i >= 0; --i)
+	{
+		FreeList.Add(&Slab[i]);
+	}
+	Slabs.Add(MoveTemp(Slab));
+	UE_LOG(LogEnigmaVoxelChunk, Verbose, TEXT("ChunkHolderPool allocate new slab, total holders -> %d"), GetNumAllocated());
+}
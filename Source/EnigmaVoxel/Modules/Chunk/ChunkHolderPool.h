@@ -0,0 +1,40 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FChunkHolder;
+
+/**
+ * Recycling slab pool of FChunkHolder. Holders are allocated by slabs and handed back
+ * to the free list on unload, the block array and the material map keep their allocation
+ * so the next chunk does not go back to the general allocator.
+ *
+ * Only accessed from the game thread (under the UEnigmaWorld::ChunksLock write lock).
+ */
+class FChunkHolderPool
+{
+public:
+	explicit FChunkHolderPool(int32 InSlabSize = 64);
+	~FChunkHolderPool();
+
+	FChunkHolderPool(const FChunkHolderPool&)            = delete;
+	FChunkHolderPool& operator=(const FChunkHolderPool&) = delete;
+
+	/// Take a clean holder from the free list, allocate a new slab when empty
+	FChunkHolder* Acquire();
+	/// Reset the holder and give it back to the free list, the holder must not
+	/// be referenced by the world or a worker job anymore
+	void Release(FChunkHolder* Holder);
+
+	int32 GetNumAllocated() const { return Slabs.Num() * SlabSize; }
+	int32 GetNumFree() const { return FreeList.Num(); }
+
+private:
+	void AllocateSlab();
+
+	int32                              SlabSize = 64;
+	TArray<TUniquePtr<FChunkHolder[]>> Slabs;
+	TArray<FChunkHolder*>              FreeList;
+};
@@ -0,0 +1,58 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/// Edge length in blocks of every chunk, override from the Build.cs (PublicDefinitions) to build with 32^3 chunks.
+/// The only size switch: the holder storage, the indexing and the height map all follow FChunkLayout
+#ifndef ENIGMAVOXEL_CHUNK_SIZE
+#define ENIGMAVOXEL_CHUNK_SIZE 16
+#endif
+
+/**
+ * Compile-time chunk dimensions. Every size is a power of two so the voxel index is built
+ * with shifts and ORs, and loops bounded by SizeX/SizeY/SizeZ are constant trip counts the
+ * compiler can unroll and vectorise. Storage order is X first, then Y, then Z.
+ */
+template <int32 InSizeX, int32 InSizeY, int32 InSizeZ>
+struct TChunkLayout
+{
+	static constexpr int32 Log2(int32 Value) { return Value <= 1 ? 0 : 1 + Log2(Value >> 1); }
+
+	static constexpr int32 SizeX  = InSizeX;
+	static constexpr int32 SizeY  = InSizeY;
+	static constexpr int32 SizeZ  = InSizeZ;
+	static constexpr int32 Count  = SizeX * SizeY * SizeZ;
+	static constexpr int32 ShiftY = Log2(SizeX);
+	static constexpr int32 ShiftZ = Log2(SizeX) + Log2(SizeY);
+
+	static_assert((1 << Log2(SizeX)) == SizeX && (1 << Log2(SizeY)) == SizeY && (1 << Log2(SizeZ)) == SizeZ, "Chunk dimensions must be powers of two");
+
+	static constexpr FORCEINLINE int32 Index(int32 X, int32 Y, int32 Z)
+	{
+		return X | (Y << ShiftY) | (Z << ShiftZ);
+	}
+
+	static FORCEINLINE int32 Index(const FIntVector& LocalCoords)
+	{
+		return Index(LocalCoords.X, LocalCoords.Y, LocalCoords.Z);
+	}
+
+	static FORCEINLINE bool IsInside(int32 X, int32 Y, int32 Z)
+	{
+		return static_cast<uint32>(X) < static_cast<uint32>(SizeX) && static_cast<uint32>(Y) < static_cast<uint32>(SizeY) && static_cast<uint32>(Z) < static_cast<uint32>(SizeZ);
+	}
+
+	static FORCEINLINE bool IsInside(const FIntVector& LocalCoords)
+	{
+		return IsInside(LocalCoords.X, LocalCoords.Y, LocalCoords.Z);
+	}
+
+	static FORCEINLINE FIntVector GetDimension()
+	{
+		return FIntVector(SizeX, SizeY, SizeZ);
+	}
+};
+
+using FChunkLayout = TChunkLayout<ENIGMAVOXEL_CHUNK_SIZE, ENIGMAVOXEL_CHUNK_SIZE, ENIGMAVOXEL_CHUNK_SIZE>;
@@ -0,0 +1,432 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ChunkLight.h"
+#include "ChunkHolder.h"
+#include "EnigmaVoxel/Core/Log/DefinedLog.h"
+#include "EnigmaVoxel/Core/World/Gen/WorldGen.hpp"
+#include "EnigmaVoxel/Modules/Block/BlockDefinition.h"
+#include "HAL/IConsoleManager.h"
+
+namespace
+{
+	/// Down is the step the sky light follows without fading
+	const FIntVector LightSteps[6] = {
+		{1, 0, 0}, {-1, 0, 0},
+		{0, 1, 0}, {0, -1, 0},
+		{0, 0, 1}, {0, 0, -1}
+	};
+	constexpr int32 DownStep = 5;
+	constexpr int32 ShiftX   = FChunkLayout::Log2(FChunkLayout::SizeX);
+	constexpr int32 ShiftY   = FChunkLayout::Log2(FChunkLayout::SizeY);
+
+	struct FLightRemoval
+	{
+		FIntVector Pos;
+		uint8      Level;
+	};
+
+	/// Light properties of a block ID, resolved once per stage
+	struct FLightProps
+	{
+		static constexpr uint8 Unknown  = 0xFF;
+		static constexpr uint8 OpenFlag = 0x10;
+
+		TArray<uint8> Cache;
+
+		uint8 Get(uint16 BlockID)
+		{
+			if (BlockID >= Cache.Num())
+			{
+				const int32 Resolved = Cache.Num();
+				Cache.SetNumUninitialized(BlockID + 1);
+				FMemory::Memset(Cache.GetData() + Resolved, Unknown, Cache.Num() - Resolved);
+			}
+			uint8& Props = Cache[BlockID];
+			if (Props == Unknown)
+			{
+				const UBlockDefinition* Definition = FChunkHolder::ResolveBlockID(BlockID);
+				Props                              = (!Definition || !Definition->bIsOpaque ? OpenFlag : 0) | (Definition ? FMath::Min<uint8>(Definition->LightEmission, FChunkLight::MaxLevel) : 0);
+			}
+			return Props;
+		}
+
+		bool  IsOpen(uint16 BlockID) { return (Get(BlockID) & OpenFlag) != 0; }
+		uint8 GetEmission(uint16 BlockID) { return Get(BlockID) & 0xF; }
+	};
+
+	/// Voxel access across the neighbourhood, positions are local to the center chunk
+	struct FLightGrid
+	{
+		FLightNeighbourhood& Neighbourhood;
+		FLightProps          Props;
+
+		explicit FLightGrid(FLightNeighbourhood& InNeighbourhood) : Neighbourhood(InNeighbourhood) {}
+
+		/// Chunk slot and voxel index of a position, false outside the neighbourhood, the world height or a chunk without light storage
+		bool Locate(const FIntVector& Pos, int32& OutSlot, int32& OutIndex) const
+		{
+			if (static_cast<uint32>(Pos.Z) >= static_cast<uint32>(FChunkLayout::SizeZ)
+				|| Pos.X < -FChunkLayout::SizeX || Pos.X >= 2 * FChunkLayout::SizeX
+				|| Pos.Y < -FChunkLayout::SizeY || Pos.Y >= 2 * FChunkLayout::SizeY)
+			{
+				return false;
+			}
+			// Sizes are powers of two, the shift floors the negative side to -1
+			OutSlot                   = FLightNeighbourhood::GetSlot(FIntVector(Pos.X >> ShiftX, Pos.Y >> ShiftY, 0));
+			const FChunkHolder* Chunk = Neighbourhood.Chunks[OutSlot];
+			if (!Chunk || Chunk->SkyLight.IsEmpty())
+			{
+				return false;
+			}
+			OutIndex = FChunkLayout::Index(Pos.X & (FChunkLayout::SizeX - 1), Pos.Y & (FChunkLayout::SizeY - 1), Pos.Z);
+			return true;
+		}
+
+		FChunkHolder& Get(int32 Slot) const { return *Neighbourhood.Chunks[Slot]; }
+
+		static TArray<uint8>& GetNibbles(FChunkHolder& Chunk, ELightChannel Channel)
+		{
+			return Channel == ELightChannel::Sky ? Chunk.SkyLight : Chunk.BlockLight;
+		}
+
+		uint8 GetLight(ELightChannel Channel, int32 Slot, int32 Index) const
+		{
+			return FChunkLight::GetNibble(GetNibbles(Get(Slot), Channel), Index);
+		}
+
+		void SetLight(ELightChannel Channel, int32 Slot, int32 Index, uint8 Level)
+		{
+			FChunkLight::SetNibble(GetNibbles(Get(Slot), Channel), Index, Level);
+			Neighbourhood.ChangedMask |= 1 << Slot;
+		}
+
+		uint16 GetBlockID(int32 Slot, int32 Index) const { return Get(Slot).GetBlockIDAt(Index); }
+	};
+
+	void PropagateAdd(FLightGrid& Grid, ELightChannel Channel, TArray<FIntVector>& Queue)
+	{
+		for (int32 Head = 0; Head < Queue.Num(); ++Head)
+		{
+			const FIntVector Pos = Queue[Head];
+			int32            Slot, Index;
+			if (!Grid.Locate(Pos, Slot, Index))
+			{
+				continue;
+			}
+			const uint8 Level = Grid.GetLight(Channel, Slot, Index);
+			if (Level <= 1)
+			{
+				continue;
+			}
+
+			for (int32 Step = 0; Step < 6; ++Step)
+			{
+				const FIntVector Next = Pos + LightSteps[Step];
+				int32            NextSlot, NextIndex;
+				if (!Grid.Locate(Next, NextSlot, NextIndex) || !Grid.Props.IsOpen(Grid.GetBlockID(NextSlot, NextIndex)))
+				{
+					continue;
+				}
+				const bool  bSkyColumn = Channel == ELightChannel::Sky && Step == DownStep && Level == FChunkLight::MaxLevel;
+				const uint8 Target     = bSkyColumn ? Level : Level - 1;
+				if (Grid.GetLight(Channel, NextSlot, NextIndex) < Target)
+				{
+					Grid.SetLight(Channel, NextSlot, NextIndex, Target);
+					Queue.Add(Next);
+				}
+			}
+		}
+	}
+
+	/// Clear every level that came from the queued voxels, brighter or independent neighbours go to the add queue
+	void PropagateRemove(FLightGrid& Grid, ELightChannel Channel, TArray<FLightRemoval>& Queue, TArray<FIntVector>& OutAddQueue)
+	{
+		for (int32 Head = 0; Head < Queue.Num(); ++Head)
+		{
+			const FLightRemoval Removal = Queue[Head];
+			for (int32 Step = 0; Step < 6; ++Step)
+			{
+				const FIntVector Next = Removal.Pos + LightSteps[Step];
+				int32            NextSlot, NextIndex;
+				if (!Grid.Locate(Next, NextSlot, NextIndex))
+				{
+					continue;
+				}
+				const uint8 Level = Grid.GetLight(Channel, NextSlot, NextIndex);
+				if (Level == 0)
+				{
+					continue;
+				}
+
+				const bool bSkyColumn = Channel == ELightChannel::Sky && Step == DownStep && Removal.Level == FChunkLight::MaxLevel;
+				if (Level >= Removal.Level && !bSkyColumn)
+				{
+					OutAddQueue.Add(Next); // Lit by another source, spread it back into the cleared area
+					continue;
+				}
+
+				Grid.SetLight(Channel, NextSlot, NextIndex, 0);
+				Queue.Add({Next, Level});
+				if (Channel == ELightChannel::Block)
+				{
+					if (const uint8 Emission = Grid.Props.GetEmission(Grid.GetBlockID(NextSlot, NextIndex)))
+					{
+						Grid.SetLight(Channel, NextSlot, NextIndex, Emission);
+						OutAddQueue.Add(Next);
+					}
+				}
+			}
+		}
+	}
+
+	/// Queue the lit voxels of the neighbours touching the center chunk
+	void SeedFromNeighbours(FLightGrid& Grid, TArray<FIntVector>& SkyQueue, TArray<FIntVector>& BlockQueue)
+	{
+		auto Seed = [&Grid, &SkyQueue, &BlockQueue](const FIntVector& Pos)
+		{
+			int32 Slot, Index;
+			if (!Grid.Locate(Pos, Slot, Index))
+			{
+				return;
+			}
+			if (Grid.GetLight(ELightChannel::Sky, Slot, Index) > 1)
+			{
+				SkyQueue.Add(Pos);
+			}
+			if (Grid.GetLight(ELightChannel::Block, Slot, Index) > 1)
+			{
+				BlockQueue.Add(Pos);
+			}
+		};
+
+		for (int32 z = 0; z < FChunkLayout::SizeZ; ++z)
+		{
+			for (int32 y = 0; y < FChunkLayout::SizeY; ++y)
+			{
+				Seed(FIntVector(-1, y, z));
+				Seed(FIntVector(FChunkLayout::SizeX, y, z));
+			}
+			for (int32 x = 0; x < FChunkLayout::SizeX; ++x)
+			{
+				Seed(FIntVector(x, -1, z));
+				Seed(FIntVector(x, FChunkLayout::SizeY, z));
+			}
+		}
+	}
+}
+
+void FChunkLight::AllocateStorage(FChunkHolder& Holder)
+{
+	if (Holder.SkyLight.IsEmpty())
+	{
+		Holder.SkyLight.Init(0, NibbleBytes);
+		Holder.BlockLight.Init(0, NibbleBytes);
+	}
+}
+
+uint8 FChunkLight::GetPackedLight(const FChunkHolder& Holder, int32 Index)
+{
+	if (!Holder.bLit)
+	{
+		return MaxLevel << 4;
+	}
+	return static_cast<uint8>(GetNibble(Holder.SkyLight, Index) << 4 | GetNibble(Holder.BlockLight, Index));
+}
+
+void FChunkLight::LightChunk(FLightNeighbourhood& Neighbourhood)
+{
+	FChunkHolder& Center = *Neighbourhood.GetCenter();
+	check(Center.SkyLight.Num() == NibbleBytes);
+	Neighbourhood.ChangedMask |= 1 << FLightNeighbourhood::CenterSlot;
+
+	FLightGrid            Grid(Neighbourhood);
+	TArray<FIntVector>    AddQueues[2];
+	TArray<FLightRemoval> RemoveQueues[2];
+	TArray<FIntVector>&   SkyQueue   = AddQueues[static_cast<int32>(ELightChannel::Sky)];
+	TArray<FIntVector>&   BlockQueue = AddQueues[static_cast<int32>(ELightChannel::Block)];
+
+	// Take back the old light of the center and what it spread over the border, before any new source is set.
+	// A chunk lit for the first time has nothing to clear
+	for (const ELightChannel Channel : {ELightChannel::Sky, ELightChannel::Block})
+	{
+		const int32    Queue   = static_cast<int32>(Channel);
+		TArray<uint8>& Nibbles = FLightGrid::GetNibbles(Center, Channel);
+		for (int32 Index = 0; Index < FChunkLayout::Count; ++Index)
+		{
+			if (const uint8 Old = GetNibble(Nibbles, Index))
+			{
+				SetNibble(Nibbles, Index, 0);
+				RemoveQueues[Queue].Add({FIntVector(Index & (FChunkLayout::SizeX - 1), (Index >> FChunkLayout::ShiftY) & (FChunkLayout::SizeY - 1), Index >> FChunkLayout::ShiftZ), Old});
+			}
+		}
+		PropagateRemove(Grid, Channel, RemoveQueues[Queue], AddQueues[Queue]);
+	}
+
+	// Sky columns from the top of the world down to the first opaque block, read from the height map
+	for (int32 y = 0; y < FChunkLayout::SizeY; ++y)
+	{
+		for (int32 x = 0; x < FChunkLayout::SizeX; ++x)
+		{
+			for (int32 z = FChunkLayout::SizeZ - 1; z >= Center.GetColumnHeight(x, y); --z)
+			{
+				SetNibble(Center.SkyLight, FChunkLayout::Index(x, y, z), MaxLevel);
+				SkyQueue.Add(FIntVector(x, y, z));
+			}
+		}
+	}
+
+	// Emitters, a uniform chunk is one lookup
+	const uint8 UniformEmission = Center.IsUniform() ? Grid.Props.GetEmission(Center.UniformBlockID) : 0;
+	if (!Center.IsUniform() || UniformEmission > 0)
+	{
+		for (int32 Index = 0; Index < FChunkLayout::Count; ++Index)
+		{
+			const uint8 Emission = Center.IsUniform() ? UniformEmission : Grid.Props.GetEmission(Center.Blocks[Index]);
+			if (Emission > 0)
+			{
+				SetNibble(Center.BlockLight, Index, Emission);
+				BlockQueue.Add(FIntVector(Index & (FChunkLayout::SizeX - 1), (Index >> FChunkLayout::ShiftY) & (FChunkLayout::SizeY - 1), Index >> FChunkLayout::ShiftZ));
+			}
+		}
+	}
+
+	SeedFromNeighbours(Grid, SkyQueue, BlockQueue);
+	PropagateAdd(Grid, ELightChannel::Sky, SkyQueue);
+	PropagateAdd(Grid, ELightChannel::Block, BlockQueue);
+	Center.bLit = true;
+}
+
+void FChunkLight::UpdateBlocks(FLightNeighbourhood& Neighbourhood, const TArray<FIntVector>& EditedBlocks)
+{
+	check(Neighbourhood.GetCenter() && Neighbourhood.GetCenter()->bLit);
+
+	FLightGrid            Grid(Neighbourhood);
+	TArray<FIntVector>    AddQueues[2];
+	TArray<FLightRemoval> RemoveQueues[2];
+	for (const FIntVector& Pos : EditedBlocks)
+	{
+		int32 Slot, Index;
+		if (!Grid.Locate(Pos, Slot, Index))
+		{
+			continue;
+		}
+		const uint16 BlockID  = Grid.GetBlockID(Slot, Index);
+		const bool   bOpen    = Grid.Props.IsOpen(BlockID);
+		const uint8  Emission = Grid.Props.GetEmission(BlockID);
+
+		for (const ELightChannel Channel : {ELightChannel::Sky, ELightChannel::Block})
+		{
+			const int32 Queue = static_cast<int32>(Channel);
+			if (const uint8 Old = Grid.GetLight(Channel, Slot, Index))
+			{
+				Grid.SetLight(Channel, Slot, Index, 0);
+				RemoveQueues[Queue].Add({Pos, Old});
+			}
+			if (Channel == ELightChannel::Block && Emission > 0)
+			{
+				Grid.SetLight(Channel, Slot, Index, Emission);
+				AddQueues[Queue].Add(Pos);
+			}
+			if (bOpen)
+			{
+				// Let the neighbours flow back into the block
+				for (const FIntVector& Step : LightSteps)
+				{
+					AddQueues[Queue].Add(Pos + Step);
+				}
+			}
+		}
+	}
+
+	// Clear first, the add pass then refills the cleared area from what is left
+	for (const ELightChannel Channel : {ELightChannel::Sky, ELightChannel::Block})
+	{
+		const int32 Queue = static_cast<int32>(Channel);
+		PropagateRemove(Grid, Channel, RemoveQueues[Queue], AddQueues[Queue]);
+		PropagateAdd(Grid, Channel, AddQueues[Queue]);
+	}
+}
+
+void FChunkLight::RunBenchmark(int32 ChunkCount, int32 EditCount)
+{
+	const int32 Side = FMath::Max(1, FMath::CeilToInt32(FMath::Sqrt(static_cast<float>(FMath::Max(1, ChunkCount)))));
+
+	// Surface terrain with random holes, as generated chunks would look
+	FRandomStream                    Random(1234);
+	const uint16                     SurfaceID = FChunkHolder::ToBlockID(FWorldGen::SampleSurfaceBlock(0, 0));
+	TArray<TUniquePtr<FChunkHolder>> Holders;
+	for (int32 i = 0; i < Side * Side; ++i)
+	{
+		FChunkHolder& Holder = *Holders.Add_GetRef(MakeUnique<FChunkHolder>());
+		Holder.Coords        = FIntVector(i % Side, i / Side, 0);
+		Holder.Materialize();
+		AllocateStorage(Holder);
+		for (int32 y = 0; y < FChunkLayout::SizeY; ++y)
+		{
+			for (int32 x = 0; x < FChunkLayout::SizeX; ++x)
+			{
+				const int32 Height = FWorldGen::SampleHeight(Holder.Coords.X * FChunkLayout::SizeX + x, Holder.Coords.Y * FChunkLayout::SizeY + y);
+				for (int32 z = 0; z < Height && z < FChunkLayout::SizeZ; ++z)
+				{
+					Holder.Blocks[FChunkLayout::Index(x, y, z)] = Random.FRand() < 0.1f ? 0 : SurfaceID;
+				}
+			}
+		}
+		Holder.RebuildHeightMap();
+	}
+
+	auto MakeNeighbourhood = [&Holders, Side](int32 CX, int32 CY)
+	{
+		FLightNeighbourhood Neighbourhood;
+		for (int32 dy = -1; dy <= 1; ++dy)
+		{
+			for (int32 dx = -1; dx <= 1; ++dx)
+			{
+				const int32 X = CX + dx;
+				const int32 Y = CY + dy;
+				if (X >= 0 && X < Side && Y >= 0 && Y < Side)
+				{
+					Neighbourhood.Chunks[FLightNeighbourhood::GetSlot(FIntVector(dx, dy, 0))] = Holders[X + Y * Side].Get();
+				}
+			}
+		}
+		return Neighbourhood;
+	};
+
+	const double LightStart = FPlatformTime::Seconds();
+	for (int32 i = 0; i < Holders.Num(); ++i)
+	{
+		FLightNeighbourhood Neighbourhood = MakeNeighbourhood(i % Side, i / Side);
+		LightChunk(Neighbourhood);
+	}
+	const double LightSeconds = FPlatformTime::Seconds() - LightStart;
+
+	// Toggle random blocks between air and surface, one stage per edit like a player digging and placing
+	const double EditStart = FPlatformTime::Seconds();
+	for (int32 i = 0; i < EditCount; ++i)
+	{
+		const int32      Chunk  = Random.RandHelper(Holders.Num());
+		FChunkHolder&    Holder = *Holders[Chunk];
+		const FIntVector Local(Random.RandHelper(FChunkLayout::SizeX), Random.RandHelper(FChunkLayout::SizeY), Random.RandHelper(FChunkLayout::SizeZ));
+		const int32      Index  = FChunkLayout::Index(Local);
+		Holder.SetBlockID(Local, Holder.Blocks[Index] == 0 ? SurfaceID : 0);
+
+		FLightNeighbourhood Neighbourhood = MakeNeighbourhood(Chunk % Side, Chunk / Side);
+		UpdateBlocks(Neighbourhood, {Local});
+	}
+	const double EditSeconds = FPlatformTime::Seconds() - EditStart;
+
+	UE_LOG(LogEnigmaVoxelChunk, Display, TEXT("Light benchmark: %d chunks lit in %.2f ms (%.0f chunks/s), %d edits in %.2f ms (%.0f edits/s)"),
+	       Holders.Num(), LightSeconds * 1000.0, Holders.Num() / FMath::Max(LightSeconds, 1e-9),
+	       EditCount, EditSeconds * 1000.0, EditCount / FMath::Max(EditSeconds, 1e-9));
+}
+
+static FAutoConsoleCommand GLightBenchmarkCommand(
+	TEXT("Enigma.LightBenchmark"),
+	TEXT("Relight synthetic chunks and apply random block edits, log the light throughput. Args: [ChunkCount=256] [EditCount=10000]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		const int32 ChunkCount = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 256;
+		const int32 EditCount  = Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 10000;
+		FChunkLight::RunBenchmark(ChunkCount, EditCount);
+	}));
@@ -0,0 +1,76 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ChunkLayout.h"
+
+struct FChunkHolder;
+
+enum class ELightChannel : uint8
+{
+	Sky, // Straight down from the top of the world without loss, then fades by one per block
+	Block // Emitted by UBlockDefinition::LightEmission, fades by one per block
+};
+
+/**
+ * The lit chunk and its 8 horizontal neighbours, the only chunks a light stage touches.
+ * Light fades by one level per block from 15, it never travels further than one chunk
+ * away from the block that changed. Positions are local to the center chunk and range
+ * over [-Size, 2 * Size) horizontally, a missing neighbour or one without light storage
+ * blocks the light.
+ */
+struct FLightNeighbourhood
+{
+	FChunkHolder* Chunks[9]   = {}; // (X + 1) + (Y + 1) * 3, center at 4
+	uint16        ChangedMask = 0; // Same bits, chunks whose light changed during the stage
+
+	static constexpr int32 CenterSlot = 4;
+
+	FChunkHolder* GetCenter() const { return Chunks[CenterSlot]; }
+	static int32  GetSlot(const FIntVector& ChunkOffset) { return (ChunkOffset.X + 1) + (ChunkOffset.Y + 1) * 3; }
+};
+
+/**
+ * Flood-fill voxel light. Every chunk stores two nibble arrays, sky and block light, 15 is
+ * the brightest. Propagation is breadth-first, an edit first runs the remove queue from the
+ * edited block (every level that came from it goes back to 0, brighter neighbours met on the
+ * way are re-queued) and then the add queue, so only the area the edit can reach is relit.
+ *
+ * A light stage only writes inside its FLightNeighbourhood, the world runs the stages of chunks
+ * three chunks apart in parallel on the worker pool.
+ */
+struct FChunkLight
+{
+	static constexpr uint8 MaxLevel    = 15;
+	static constexpr int32 NibbleBytes = FChunkLayout::Count / 2;
+
+	static FORCEINLINE uint8 GetNibble(const TArray<uint8>& Nibbles, int32 Index)
+	{
+		return (Nibbles[Index >> 1] >> ((Index & 1) << 2)) & 0xF;
+	}
+
+	static FORCEINLINE void SetNibble(TArray<uint8>& Nibbles, int32 Index, uint8 Level)
+	{
+		const int32 Shift = (Index & 1) << 2;
+		uint8&      Byte  = Nibbles[Index >> 1];
+		Byte              = static_cast<uint8>((Byte & ~(0xF << Shift)) | ((Level & 0xF) << Shift));
+	}
+
+	/// Allocate the nibble arrays on the game thread, a light stage never resizes them under the readers
+	static void AllocateStorage(FChunkHolder& Holder);
+
+	/// Sky << 4 | Block of a voxel, a chunk not lit yet reads as full sky
+	static uint8 GetPackedLight(const FChunkHolder& Holder, int32 Index);
+
+	/// Full light of the center chunk: sky columns, emitters and the light of the neighbours borders.
+	/// The light the center held before is removed across the border first, a chunk whose blocks
+	/// were replaced (chunk packet) leaves no stale light in its neighbours
+	static void LightChunk(FLightNeighbourhood& Neighbourhood);
+
+	/// Incremental update after the blocks at EditedBlocks (center local coords) changed. The center must be lit
+	static void UpdateBlocks(FLightNeighbourhood& Neighbourhood, const TArray<FIntVector>& EditedBlocks);
+
+	/// Relight synthetic chunks and edit random blocks, log the throughput of both stages
+	static void RunBenchmark(int32 ChunkCount, int32 EditCount);
+};
@@ -0,0 +1,111 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ChunkLod.h"
+#include "ChunkHolder.h"
+#include "EnigmaVoxel/Modules/Block/Block.h"
+#include "EnigmaVoxel/Modules/Block/Enum/BlockDirection.h"
+
+namespace
+{
+	struct FCellFace
+	{
+		EBlockDirection Direction;
+		FIntVector      Offset;
+	};
+
+	const FCellFace CellFaces[6] = {
+		{EBlockDirection::NORTH, {1, 0, 0}},
+		{EBlockDirection::SOUTH, {-1, 0, 0}},
+		{EBlockDirection::EAST, {0, 1, 0}},
+		{EBlockDirection::WEST, {0, -1, 0}},
+		{EBlockDirection::UP, {0, 0, 1}},
+		{EBlockDirection::DOWN, {0, 0, -1}}
+	};
+
+	/// Block ID of a reduced cell, 0 (air) unless the solid blocks are the majority
+	uint16 SampleCell(const FChunkHolder& Holder, const FIntVector& Cell, int32 CellSize)
+	{
+		const FIntVector Origin = Cell * CellSize;
+		int32            Solid  = 0;
+		uint16           TopID  = 0;
+		for (int32 z = 0; z < CellSize; ++z)
+		{
+			for (int32 y = 0; y < CellSize; ++y)
+			{
+				for (int32 x = 0; x < CellSize; ++x)
+				{
+					const uint16 BlockID = Holder.GetBlockIDAt(FChunkLayout::Index(Origin.X + x, Origin.Y + y, Origin.Z + z));
+					if (BlockID != 0)
+					{
+						++Solid;
+						TopID = BlockID; // Z goes up, the last one is the top surface
+					}
+				}
+			}
+		}
+		return Solid * 2 >= CellSize * CellSize * CellSize ? TopID : 0;
+	}
+}
+
+void FChunkLod::BuildMesh(FChunkHolder& Holder, int32 Level, UE::Geometry::FDynamicMesh3& Mesh)
+{
+	const int32      CellSize = GetCellSize(Level);
+	const FIntVector Cells    = FChunkLayout::GetDimension() / CellSize;
+	auto             GetIndex = [&Cells](const FIntVector& Cell)
+	{
+		return Cell.X + (Cell.Y + Cell.Z * Cells.Y) * Cells.X;
+	};
+	auto IsInside = [&Cells](const FIntVector& Cell)
+	{
+		return Cell.X >= 0 && Cell.Y >= 0 && Cell.Z >= 0 && Cell.X < Cells.X && Cell.Y < Cells.Y && Cell.Z < Cells.Z;
+	};
+
+	// Reduce the blocks first, the face test reads every cell up to six times
+	TArray<uint16> Grid;
+	Grid.SetNumUninitialized(Cells.X * Cells.Y * Cells.Z);
+	for (int32 z = 0; z < Cells.Z; ++z)
+	{
+		for (int32 y = 0; y < Cells.Y; ++y)
+		{
+			for (int32 x = 0; x < Cells.X; ++x)
+			{
+				const FIntVector Cell(x, y, z);
+				Grid[GetIndex(Cell)] = SampleCell(Holder, Cell, CellSize);
+			}
+		}
+	}
+
+	const float CellWorldSize = Holder.BlockSize * CellSize;
+	for (int32 z = 0; z < Cells.Z; ++z)
+	{
+		for (int32 y = 0; y < Cells.Y; ++y)
+		{
+			for (int32 x = 0; x < Cells.X; ++x)
+			{
+				const FIntVector Cell(x, y, z);
+				const uint16     BlockID = Grid[GetIndex(Cell)];
+				if (BlockID == 0)
+				{
+					continue;
+				}
+				const FBlock Block(Cell, FChunkHolder::ResolveBlockID(BlockID));
+				if (!Block.Definition)
+				{
+					continue;
+				}
+
+				for (const FCellFace& Face : CellFaces)
+				{
+					const FIntVector Neighbour = Cell + Face.Offset;
+					if (IsInside(Neighbour) && Grid[GetIndex(Neighbour)] != 0)
+					{
+						continue; // Inner face
+					}
+					int32       TextureLayer;
+					const int32 SectionID = Holder.GetFaceSection(Block, Face.Direction, TextureLayer);
+					AppendFaceForBlock(Mesh, Cell, Face.Direction, SectionID, CellWorldSize, TextureLayer);
+				}
+			}
+		}
+	}
+}
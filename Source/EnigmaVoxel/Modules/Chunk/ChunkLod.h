@@ -0,0 +1,30 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FChunkHolder;
+namespace UE::Geometry
+{
+	class FDynamicMesh3;
+}
+
+/**
+ * Reduced meshes for distant chunks. Level N merges 2^N blocks per axis into one cell: a cell
+ * is solid when at least half of its blocks are (majority), and takes the block of its
+ * topmost solid voxel so the visible terrain surface keeps its material (top-surface).
+ *
+ * Cells are meshed against the reduced grid only. Faces on the chunk border are always kept,
+ * they hang as skirts over the cracks left by a neighbour meshed at another level. A full
+ * detail neighbour keeps its own border faces against a reduced chunk in turn
+ * (UEnigmaWorld::IsChunkMeshedAtFullDetail), they close the step where a column is rounded down.
+ */
+struct FChunkLod
+{
+	static constexpr int32 MaxLevel = 2; // 4x
+
+	static int32 GetCellSize(int32 Level) { return 1 << FMath::Clamp(Level, 0, MaxLevel); }
+
+	static void BuildMesh(FChunkHolder& Holder, int32 Level, UE::Geometry::FDynamicMesh3& Mesh);
+};
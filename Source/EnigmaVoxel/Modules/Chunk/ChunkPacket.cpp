@@ -0,0 +1,370 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ChunkPacket.h"
+#include "ChunkHolder.h"
+#include "EnigmaVoxel/Core/Log/DefinedLog.h"
+#include "EnigmaVoxel/Core/Register/EnigmaRegistrationSubsystem.h"
+#include "Serialization/BitReader.h"
+#include "Serialization/BitWriter.h"
+
+namespace
+{
+	enum class EIndexEncoding : uint8
+	{
+		Packed, // One palette index per voxel
+		Runs // (palette index, packed run length) pairs
+	};
+
+	/// Bytes FArchive::SerializeIntPacked spends on a value, 7 bits per byte
+	int32 GetPackedIntBytes(uint32 Value)
+	{
+		int32 Bytes = 1;
+		while (Value >= 0x80)
+		{
+			Value >>= 7;
+			++Bytes;
+		}
+		return Bytes;
+	}
+
+	void WritePacketHeader(FBitWriter& Writer, FChunkPacket::EType Type, const FIntVector& ChunkCoords)
+	{
+		uint8 PacketVersion = FChunkPacket::Version;
+		uint8 PacketType    = static_cast<uint8>(Type);
+		int32 X             = ChunkCoords.X;
+		int32 Y             = ChunkCoords.Y;
+		Writer << PacketVersion << PacketType << X << Y;
+	}
+
+	bool ReadPacketHeader(FBitReader& Reader, FChunkPacket::EType& OutType, FIntVector& OutChunkCoords)
+	{
+		uint8 PacketVersion = 0;
+		uint8 PacketType    = 0;
+		int32 X             = 0;
+		int32 Y             = 0;
+		Reader << PacketVersion << PacketType << X << Y;
+		if (Reader.IsError() || PacketVersion != FChunkPacket::Version || PacketType > static_cast<uint8>(FChunkPacket::EType::Delta))
+		{
+			return false;
+		}
+		OutType        = static_cast<FChunkPacket::EType>(PacketType);
+		OutChunkCoords = FIntVector(X, Y, 0);
+		return true;
+	}
+
+	void Finish(FBitWriter& Writer, TArray<uint8>& OutPacket)
+	{
+		OutPacket.SetNumUninitialized(Writer.GetNumBytes());
+		FMemory::Memcpy(OutPacket.GetData(), Writer.GetData(), Writer.GetNumBytes());
+	}
+}
+
+void FChunkPacket::WriteChunk(const FChunkHolder& Holder, TArray<uint8>& OutPacket)
+{
+	FBitWriter Writer(0, true);
+	WritePacketHeader(Writer, EType::Full, Holder.Coords);
+
+	bool bUniform = Holder.IsUniform();
+	Writer.WriteBit(bUniform);
+	if (bUniform)
+	{
+		uint16 UniformBlockID = Holder.UniformBlockID;
+		Writer << UniformBlockID;
+	}
+	else
+	{
+		// Palette in first seen order, the runs of the same block make the lookups rare
+		TArray<uint16>      Palette;
+		TMap<uint16, int32> PaletteIndices;
+		TArray<int32>       Indices;
+		Indices.SetNumUninitialized(FChunkLayout::Count);
+		int32 RunCount      = 0;
+		int32 RunLengthSize = 0;
+		int32 RunStart      = 0;
+		for (int32 i = 0; i < FChunkLayout::Count; ++i)
+		{
+			const uint16 BlockID = Holder.Blocks[i];
+			if (i > 0 && BlockID == Holder.Blocks[i - 1])
+			{
+				Indices[i] = Indices[i - 1];
+				continue;
+			}
+			if (i > 0)
+			{
+				++RunCount;
+				RunLengthSize += GetPackedIntBytes(i - RunStart) * 8;
+			}
+			RunStart = i;
+			if (const int32* Found = PaletteIndices.Find(BlockID))
+			{
+				Indices[i] = *Found;
+			}
+			else
+			{
+				Indices[i] = Palette.Add(BlockID);
+				PaletteIndices.Add(BlockID, Indices[i]);
+			}
+		}
+		++RunCount;
+		RunLengthSize += GetPackedIntBytes(FChunkLayout::Count - RunStart) * 8;
+
+		uint32 PaletteNum = Palette.Num();
+		Writer.SerializeIntPacked(PaletteNum);
+		for (uint16 BlockID : Palette)
+		{
+			Writer << BlockID;
+		}
+
+		const int32          IndexBits  = FMath::Max(1, static_cast<int32>(FMath::CeilLogTwo(PaletteNum)));
+		const int64          RunsSize   = static_cast<int64>(RunCount) * IndexBits + RunLengthSize;
+		const int64          PackedSize = static_cast<int64>(FChunkLayout::Count) * IndexBits;
+		const EIndexEncoding Encoding   = RunsSize < PackedSize ? EIndexEncoding::Runs : EIndexEncoding::Packed;
+		Writer.WriteBit(Encoding == EIndexEncoding::Runs);
+		if (Encoding == EIndexEncoding::Runs)
+		{
+			uint32 Runs = RunCount;
+			Writer.SerializeIntPacked(Runs);
+			for (int32 Start = 0; Start < FChunkLayout::Count;)
+			{
+				int32 End = Start + 1;
+				while (End < FChunkLayout::Count && Indices[End] == Indices[Start])
+				{
+					++End;
+				}
+				uint32 Index  = Indices[Start];
+				uint32 Length = End - Start;
+				Writer.SerializeBits(&Index, IndexBits);
+				Writer.SerializeIntPacked(Length);
+				Start = End;
+			}
+		}
+		else
+		{
+			for (int32 i = 0; i < FChunkLayout::Count; ++i)
+			{
+				uint32 Index = Indices[i];
+				Writer.SerializeBits(&Index, IndexBits);
+			}
+		}
+	}
+
+	// Packed count and bounded voxel keys, the reader checks both before it allocates
+	uint32 ExtraNum = Holder.ExtraData.Num();
+	Writer.SerializeIntPacked(ExtraNum);
+	for (const TPair<int32, FBlockExtraData>& Extra : Holder.ExtraData)
+	{
+		uint32          Index = Extra.Key;
+		FBlockExtraData Data  = Extra.Value;
+		Writer.SerializeInt(Index, FChunkLayout::Count);
+		Writer << Data;
+	}
+	Finish(Writer, OutPacket);
+}
+
+void FChunkPacket::WriteDelta(const FIntVector& ChunkCoords, const TArray<FChunkBlockChange>& Changes, TArray<uint8>& OutPacket)
+{
+	FBitWriter Writer(0, true);
+	WritePacketHeader(Writer, EType::Delta, ChunkCoords);
+
+	// Edits cluster (explosions, builds), the gap to the previous voxel mostly fits in one byte
+	uint32 ChangeNum = Changes.Num();
+	Writer.SerializeIntPacked(ChangeNum);
+	int32 Previous = 0;
+	for (const FChunkBlockChange& Change : Changes)
+	{
+		check(Change.Index >= Previous);
+		uint32 Gap     = Change.Index - Previous;
+		uint16 BlockID = Change.BlockID;
+		Writer.SerializeIntPacked(Gap);
+		Writer << BlockID;
+		Previous = Change.Index;
+	}
+	Finish(Writer, OutPacket);
+}
+
+void FChunkPacket::CoalesceChanges(TArray<FChunkBlockChange>& Changes)
+{
+	TBitArray<>               Seen(false, FChunkLayout::Count);
+	TArray<FChunkBlockChange> Coalesced;
+	Coalesced.Reserve(Changes.Num());
+	for (int32 i = Changes.Num() - 1; i >= 0; --i)
+	{
+		if (!Seen[Changes[i].Index])
+		{
+			Seen[Changes[i].Index] = true;
+			Coalesced.Add(Changes[i]);
+		}
+	}
+	Coalesced.Sort([](const FChunkBlockChange& A, const FChunkBlockChange& B)
+	{
+		return A.Index < B.Index;
+	});
+	Changes = MoveTemp(Coalesced);
+}
+
+bool FChunkPacket::ReadHeader(const TArray<uint8>& Packet, EType& OutType, FIntVector& OutChunkCoords)
+{
+	FBitReader Reader(Packet.GetData(), static_cast<int64>(Packet.Num()) * 8);
+	return ReadPacketHeader(Reader, OutType, OutChunkCoords);
+}
+
+bool FChunkPacket::ReadChunk(const TArray<uint8>& Packet, FChunkHolder& Holder)
+{
+	FBitReader Reader(Packet.GetData(), static_cast<int64>(Packet.Num()) * 8);
+	EType      Type;
+	FIntVector ChunkCoords;
+	if (!ReadPacketHeader(Reader, Type, ChunkCoords) || Type != EType::Full)
+	{
+		return false;
+	}
+
+	const int64    MaxBlockID     = UEnigmaRegistrationSubsystem::BLOCK_GET_MAX_ID();
+	const bool     bUniform       = Reader.ReadBit() != 0;
+	uint16         UniformBlockID = 0;
+	TArray<uint16> Blocks;
+	if (bUniform)
+	{
+		Reader << UniformBlockID;
+		if (UniformBlockID > MaxBlockID)
+		{
+			return false;
+		}
+	}
+	else
+	{
+		uint32 PaletteNum = 0;
+		Reader.SerializeIntPacked(PaletteNum);
+		if (PaletteNum == 0 || PaletteNum > static_cast<uint32>(FChunkLayout::Count))
+		{
+			return false;
+		}
+		TArray<uint16> Palette;
+		Palette.SetNumUninitialized(PaletteNum);
+		for (uint16& BlockID : Palette)
+		{
+			Reader << BlockID;
+			if (BlockID > MaxBlockID)
+			{
+				return false;
+			}
+		}
+
+		const int32 IndexBits = FMath::Max(1, static_cast<int32>(FMath::CeilLogTwo(PaletteNum)));
+		Blocks.SetNumUninitialized(FChunkLayout::Count);
+		if (Reader.ReadBit())
+		{
+			uint32 Runs = 0;
+			Reader.SerializeIntPacked(Runs);
+			int32 Written = 0;
+			for (uint32 Run = 0; Run < Runs && !Reader.IsError(); ++Run)
+			{
+				uint32 Index  = 0;
+				uint32 Length = 0;
+				Reader.SerializeBits(&Index, IndexBits);
+				Reader.SerializeIntPacked(Length);
+				if (Index >= PaletteNum || Length > static_cast<uint32>(FChunkLayout::Count - Written))
+				{
+					return false;
+				}
+				for (uint32 i = 0; i < Length; ++i)
+				{
+					Blocks[Written++] = Palette[Index];
+				}
+			}
+			if (Written != FChunkLayout::Count)
+			{
+				return false;
+			}
+		}
+		else
+		{
+			for (int32 i = 0; i < FChunkLayout::Count; ++i)
+			{
+				uint32 Index = 0;
+				Reader.SerializeBits(&Index, IndexBits);
+				if (Index >= PaletteNum)
+				{
+					return false;
+				}
+				Blocks[i] = Palette[Index];
+			}
+		}
+	}
+
+	uint32 ExtraNum = 0;
+	Reader.SerializeIntPacked(ExtraNum);
+	if (ExtraNum > static_cast<uint32>(FChunkLayout::Count))
+	{
+		return false;
+	}
+	TMap<int32, FBlockExtraData> ExtraData;
+	ExtraData.Reserve(ExtraNum);
+	for (uint32 i = 0; i < ExtraNum && !Reader.IsError(); ++i)
+	{
+		uint32          Index = 0;
+		FBlockExtraData Data;
+		Reader.SerializeInt(Index, FChunkLayout::Count);
+		Reader << Data;
+		if (Index >= static_cast<uint32>(FChunkLayout::Count))
+		{
+			return false;
+		}
+		ExtraData.Add(Index, MoveTemp(Data));
+	}
+	if (Reader.IsError())
+	{
+		UE_LOG(LogEnigmaVoxelChunk, Warning, TEXT("Chunk packet -> %s is truncated"), *ChunkCoords.ToString());
+		return false;
+	}
+
+	if (bUniform)
+	{
+		Holder.SetUniform(UniformBlockID);
+	}
+	else
+	{
+		Holder.bUniform = false;
+		Holder.Blocks   = MoveTemp(Blocks);
+	}
+	Holder.ExtraData = MoveTemp(ExtraData);
+	if (!Holder.TryCompactUniform())
+	{
+		Holder.RebuildHeightMap();
+	}
+	return true;
+}
+
+bool FChunkPacket::ReadDelta(const TArray<uint8>& Packet, TArray<FChunkBlockChange>& OutChanges)
+{
+	FBitReader Reader(Packet.GetData(), static_cast<int64>(Packet.Num()) * 8);
+	EType      Type;
+	FIntVector ChunkCoords;
+	if (!ReadPacketHeader(Reader, Type, ChunkCoords) || Type != EType::Delta)
+	{
+		return false;
+	}
+
+	uint32 ChangeNum = 0;
+	Reader.SerializeIntPacked(ChangeNum);
+	if (ChangeNum > static_cast<uint32>(FChunkLayout::Count))
+	{
+		return false;
+	}
+	OutChanges.Reset(ChangeNum);
+	const int64 MaxBlockID = UEnigmaRegistrationSubsystem::BLOCK_GET_MAX_ID();
+	uint32      Index      = 0;
+	for (uint32 i = 0; i < ChangeNum; ++i)
+	{
+		uint32 Gap     = 0;
+		uint16 BlockID = 0;
+		Reader.SerializeIntPacked(Gap);
+		Reader << BlockID;
+		if (Reader.IsError() || Gap >= static_cast<uint32>(FChunkLayout::Count) - Index || BlockID > MaxBlockID)
+		{
+			return false;
+		}
+		Index += Gap;
+		OutChanges.Add({static_cast<int32>(Index), BlockID});
+	}
+	return true;
+}
@@ -0,0 +1,53 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FChunkHolder;
+
+/// One replicated block change, voxel index in its chunk (FChunkLayout::Index) and the new global block ID
+struct FChunkBlockChange
+{
+	int32  Index   = 0;
+	uint16 BlockID = 0;
+};
+
+/**
+ * Network encoding of the chunk data, written with the engine bit streams so packets go
+ * through the net driver as plain RPC byte arrays.
+ *
+ * A full packet lists the distinct block IDs of the chunk (the palette), every voxel is an
+ * index into it on ceil(log2(palette size)) bits. The indices are either bit-packed one per
+ * voxel or, when it is smaller, stored as runs of (index, packed length): terrain is mostly
+ * long runs of air and stone. An uniform chunk is a single block ID. The sparse extra data
+ * follows. A delta packet is the change record of a chunk the receiver already holds: every
+ * block of the chunk changed during one world tick, in voxel order with packed index gaps.
+ *
+ * Block IDs are the registration IDs (UBlockDefinition::BlockID), the server and its
+ * clients must register the same content. Every count read from a packet is bounded by the
+ * chunk size and every block ID by the registry before anything is allocated or written,
+ * a packet failing one check is rejected whole.
+ */
+struct FChunkPacket
+{
+	static constexpr uint8 Version = 3;
+
+	enum class EType : uint8
+	{
+		Full,
+		Delta
+	};
+
+	static void WriteChunk(const FChunkHolder& Holder, TArray<uint8>& OutPacket);
+	/// Changes must be coalesced (CoalesceChanges)
+	static void WriteDelta(const FIntVector& ChunkCoords, const TArray<FChunkBlockChange>& Changes, TArray<uint8>& OutPacket);
+	/// Keep the last change of every voxel, sorted by voxel index
+	static void CoalesceChanges(TArray<FChunkBlockChange>& Changes);
+
+	/// False if the packet is malformed or from another version
+	static bool ReadHeader(const TArray<uint8>& Packet, EType& OutType, FIntVector& OutChunkCoords);
+	/// Replace the holder blocks and extra data, the holder is left untouched on failure
+	static bool ReadChunk(const TArray<uint8>& Packet, FChunkHolder& Holder);
+	static bool ReadDelta(const TArray<uint8>& Packet, TArray<FChunkBlockChange>& OutChanges);
+};
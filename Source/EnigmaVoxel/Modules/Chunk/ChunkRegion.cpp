@@ -0,0 +1,37 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ChunkRegion.h"
+
+void FRegionMesh::Merge(FRegionMesh& Region, const TArray<TSharedPtr<const FRegionMember>>& Members)
+{
+	UE::Geometry::FDynamicMesh3      Mesh;
+	TMap<UMaterialInterface*, int32> MaterialToSection;
+	TMap<int32, int32>               SectionRemap;
+	TArray<int32>                    VertexRemap;
+	for (const TSharedPtr<const FRegionMember>& Member : Members)
+	{
+		// Chunk section -> region section, keyed by material
+		SectionRemap.Reset();
+		for (const TPair<UMaterialInterface*, int32>& P : Member->MaterialToSection)
+		{
+			const int32* Found = MaterialToSection.Find(P.Key);
+			SectionRemap.Add(P.Value, Found ? *Found : MaterialToSection.Add(P.Key, MaterialToSection.Num() + 1));
+		}
+
+		const UE::Geometry::FDynamicMesh3& Source = Member->Mesh;
+		VertexRemap.SetNumUninitialized(Source.MaxVertexID(), EAllowShrinking::No);
+		for (const int32 VertexID : Source.VertexIndicesItr())
+		{
+			VertexRemap[VertexID] = Mesh.AppendVertex(Source.GetVertex(VertexID) + Member->Offset);
+		}
+		for (const int32 TriangleID : Source.TriangleIndicesItr())
+		{
+			const UE::Geometry::FIndex3i Triangle = Source.GetTriangle(TriangleID);
+			Mesh.AppendTriangle(VertexRemap[Triangle.A], VertexRemap[Triangle.B], VertexRemap[Triangle.C], SectionRemap.FindRef(Source.GetTriangleGroup(TriangleID)));
+		}
+	}
+
+	Region.Mesh              = MoveTemp(Mesh);
+	Region.MaterialToSection = MoveTemp(MaterialToSection);
+	Region.bReady.store(true, std::memory_order_release);
+}
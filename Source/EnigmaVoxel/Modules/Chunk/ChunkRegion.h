@@ -0,0 +1,30 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DynamicMesh/DynamicMesh3.h"
+
+/// Render mesh of a chunk drawn by its region cluster, copied when the chunk is uploaded so
+/// the merge never reads a holder a worker may be rebuilding
+struct FRegionMember
+{
+	FVector                          Offset = FVector::ZeroVector; // Chunk origin in region local space
+	UE::Geometry::FDynamicMesh3      Mesh;
+	TMap<UMaterialInterface*, int32> MaterialToSection;
+};
+
+/**
+ * Region cluster: a square of distant chunks drawn as a single mesh component, one actor
+ * and one draw per material for the whole square instead of one per chunk. The member
+ * meshes are merged on a worker, materials shared by several chunks end up in one section.
+ */
+struct FRegionMesh
+{
+	FIntVector                       Coords = FIntVector::ZeroValue; // In regions
+	UE::Geometry::FDynamicMesh3      Mesh;
+	TMap<UMaterialInterface*, int32> MaterialToSection;
+	std::atomic<bool>                bReady{false}; // Merge done, set by the worker
+
+	static void Merge(FRegionMesh& Region, const TArray<TSharedPtr<const FRegionMember>>& Members);
+};
@@ -0,0 +1,216 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ChunkVisibility.h"
+#include "ChunkHolder.h"
+#include "EnigmaVoxel/Modules/Block/BlockDefinition.h"
+#include "EnigmaVoxel/Modules/Block/Enum/BlockDirection.h"
+
+namespace
+{
+	uint8 FaceBit(EBlockDirection Direction)
+	{
+		return 1 << static_cast<uint8>(Direction);
+	}
+
+	EBlockDirection Opposite(EBlockDirection Direction)
+	{
+		switch (Direction)
+		{
+		case EBlockDirection::EAST:
+			return EBlockDirection::WEST;
+		case EBlockDirection::WEST:
+			return EBlockDirection::EAST;
+		case EBlockDirection::UP:
+			return EBlockDirection::DOWN;
+		case EBlockDirection::DOWN:
+			return EBlockDirection::UP;
+		case EBlockDirection::SOUTH:
+			return EBlockDirection::NORTH;
+		case EBlockDirection::NORTH:
+		default:
+			return EBlockDirection::SOUTH;
+		}
+	}
+
+	/// Every pair of faces in the mask is connected, both ways
+	uint64 ConnectFaces(uint8 FaceMask)
+	{
+		uint64 Connections = 0;
+		for (int32 A = 0; A < 6; ++A)
+		{
+			if (!(FaceMask & (1 << A)))
+			{
+				continue;
+			}
+			for (int32 B = 0; B < 6; ++B)
+			{
+				if (FaceMask & (1 << B))
+				{
+					Connections |= 1ull << (A * 6 + B);
+				}
+			}
+		}
+		return Connections;
+	}
+
+	bool IsOpenBlock(uint16 BlockID)
+	{
+		if (BlockID == 0)
+		{
+			return true;
+		}
+		const UBlockDefinition* Definition = FChunkHolder::ResolveBlockID(BlockID);
+		return !Definition || !Definition->bIsOpaque;
+	}
+
+	struct FChunkStep
+	{
+		EBlockDirection Direction;
+		FIntVector      Offset;
+	};
+
+	/// Chunks are full height columns, there is no chunk above or below
+	const FChunkStep HorizontalSteps[4] = {
+		{EBlockDirection::NORTH, {1, 0, 0}},
+		{EBlockDirection::SOUTH, {-1, 0, 0}},
+		{EBlockDirection::EAST, {0, 1, 0}},
+		{EBlockDirection::WEST, {0, -1, 0}}
+	};
+}
+
+bool FChunkVisibility::IsConnected(uint64 Connections, EBlockDirection A, EBlockDirection B)
+{
+	return (Connections >> (static_cast<uint8>(A) * 6 + static_cast<uint8>(B))) & 1;
+}
+
+uint64 FChunkVisibility::ComputeConnections(const FChunkHolder& Holder)
+{
+	return ComputeConnections(Holder, IsOpenBlock);
+}
+
+uint64 FChunkVisibility::ComputeConnections(const FChunkHolder& Holder, TFunctionRef<bool(uint16 BlockID)> IsOpen)
+{
+	if (Holder.IsUniform())
+	{
+		return IsOpen(Holder.UniformBlockID) ? AllConnected : NoneConnected;
+	}
+
+	constexpr int32 Count     = FChunkLayout::Count;
+	TBitArray<>     Open(false, Count);
+	uint16          LastID    = 0;
+	bool            bLastOpen = true;
+	for (int32 i = 0; i < Count; ++i)
+	{
+		// Runs of the same block are the common case, resolve the definition on change only
+		const uint16 BlockID = Holder.Blocks[i];
+		if (BlockID != LastID)
+		{
+			LastID    = BlockID;
+			bLastOpen = IsOpen(BlockID);
+		}
+		Open[i] = bLastOpen;
+	}
+
+	TBitArray<>   Visited(false, Count);
+	TArray<int32> Queue;
+	Queue.Reserve(Count);
+	uint64 Connections = NoneConnected;
+	for (int32 Seed = 0; Seed < Count && Connections != AllConnected; ++Seed)
+	{
+		if (!Open[Seed] || Visited[Seed])
+		{
+			continue;
+		}
+
+		// Flood the open region and collect the chunk faces it touches
+		uint8 FaceMask = 0;
+		Queue.Reset();
+		Queue.Add(Seed);
+		Visited[Seed] = true;
+		for (int32 Head = 0; Head < Queue.Num(); ++Head)
+		{
+			const int32 Index = Queue[Head];
+			const int32 X     = Index & (FChunkLayout::SizeX - 1);
+			const int32 Y     = (Index >> FChunkLayout::ShiftY) & (FChunkLayout::SizeY - 1);
+			const int32 Z     = Index >> FChunkLayout::ShiftZ;
+
+			FaceMask |= X == 0 ? FaceBit(EBlockDirection::SOUTH) : 0;
+			FaceMask |= X == FChunkLayout::SizeX - 1 ? FaceBit(EBlockDirection::NORTH) : 0;
+			FaceMask |= Y == 0 ? FaceBit(EBlockDirection::WEST) : 0;
+			FaceMask |= Y == FChunkLayout::SizeY - 1 ? FaceBit(EBlockDirection::EAST) : 0;
+			FaceMask |= Z == 0 ? FaceBit(EBlockDirection::DOWN) : 0;
+			FaceMask |= Z == FChunkLayout::SizeZ - 1 ? FaceBit(EBlockDirection::UP) : 0;
+
+			const FIntVector Neighbours[6] = {
+				{X + 1, Y, Z}, {X - 1, Y, Z},
+				{X, Y + 1, Z}, {X, Y - 1, Z},
+				{X, Y, Z + 1}, {X, Y, Z - 1}
+			};
+			for (const FIntVector& N : Neighbours)
+			{
+				if (!FChunkLayout::IsInside(N))
+				{
+					continue;
+				}
+				const int32 NIndex = FChunkLayout::Index(N);
+				if (Open[NIndex] && !Visited[NIndex])
+				{
+					Visited[NIndex] = true;
+					Queue.Add(NIndex);
+				}
+			}
+		}
+		Connections |= ConnectFaces(FaceMask);
+	}
+	return Connections;
+}
+
+void FChunkVisibility::GatherVisibleChunks(const FIntVector& CameraChunk, const TSet<FIntVector>& Candidates, TFunctionRef<uint64(const FIntVector& ChunkCoords)> GetConnections, TSet<FIntVector>& OutVisible)
+{
+	struct FNode
+	{
+		FIntVector Coords;
+		int32      EnteredFrom; // Face of the chunk the walk came in through, INDEX_NONE for the camera chunk
+		uint8      TakenMask; // Directions already stepped, the walk never goes back against one of them
+	};
+
+	OutVisible.Reset();
+	OutVisible.Add(CameraChunk);
+
+	TArray<FNode> Queue;
+	Queue.Add({CameraChunk, INDEX_NONE, 0});
+
+	// The camera sees over the terrain, every chunk open to the sky is entered from above
+	for (const FIntVector& Coords : Candidates)
+	{
+		if (!OutVisible.Contains(Coords) && IsConnected(GetConnections(Coords), EBlockDirection::UP, EBlockDirection::UP))
+		{
+			OutVisible.Add(Coords);
+			Queue.Add({Coords, static_cast<int32>(EBlockDirection::UP), 0});
+		}
+	}
+	for (int32 Head = 0; Head < Queue.Num(); ++Head)
+	{
+		const FNode  Node        = Queue[Head];
+		const uint64 Connections = Candidates.Contains(Node.Coords) ? GetConnections(Node.Coords) : AllConnected;
+		for (const FChunkStep& Step : HorizontalSteps)
+		{
+			if (Node.TakenMask & FaceBit(Opposite(Step.Direction)))
+			{
+				continue;
+			}
+			if (Node.EnteredFrom != INDEX_NONE && !IsConnected(Connections, static_cast<EBlockDirection>(Node.EnteredFrom), Step.Direction))
+			{
+				continue;
+			}
+
+			const FIntVector Next = Node.Coords + Step.Offset;
+			if (!Candidates.Contains(Next) || OutVisible.Contains(Next))
+			{
+				continue;
+			}
+			OutVisible.Add(Next);
+			Queue.Add({Next, static_cast<int32>(Opposite(Step.Direction)), static_cast<uint8>(Node.TakenMask | FaceBit(Step.Direction))});
+		}
+	}
+}
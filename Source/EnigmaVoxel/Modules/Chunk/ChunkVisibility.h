@@ -0,0 +1,40 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+enum class EBlockDirection : uint8;
+struct FChunkHolder;
+
+/**
+ * Chunk occlusion graph (cave culling). While meshing, the non-opaque voxels of a chunk
+ * are flood filled and every pair of chunk faces reached by the same region is recorded as
+ * connected. A breadth-first walk from the camera chunk then only crosses a chunk from the
+ * face it entered through to a face connected to it, chunks the walk never reaches are
+ * sealed behind solid terrain and can be hidden. Chunks are full height columns, so the sky
+ * above them is one shared open space: every chunk whose open region reaches its top face
+ * is reachable through it.
+ *
+ * Connections are packed in a uint64, bit (A * 6 + B) for the EBlockDirection faces A and B.
+ */
+struct FChunkVisibility
+{
+	static constexpr uint64 AllConnected  = (1ull << 36) - 1;
+	static constexpr uint64 NoneConnected = 0;
+
+	static bool IsConnected(uint64 Connections, EBlockDirection A, EBlockDirection B);
+
+	/// Flood fill the chunk voxels, a voxel is open when it is air or its definition is not bIsOpaque
+	static uint64 ComputeConnections(const FChunkHolder& Holder);
+	/// Same flood with the open blocks chosen by the caller, content free tests
+	static uint64 ComputeConnections(const FChunkHolder& Holder, TFunctionRef<bool(uint16 BlockID)> IsOpen);
+
+	/// Walk the chunk graph from the camera chunk and from every chunk open to the sky (entered
+	/// through its UP face). Chunks are full height columns so the steps are horizontal, the walk
+	/// never steps back against a direction it already took.
+	/// @param Candidates Chunks that can be visible (the loaded ones), the walk does not leave them
+	/// @param GetConnections Face connections of a candidate chunk
+	/// @param OutVisible Reached candidates, the camera chunk included
+	static void GatherVisibleChunks(const FIntVector& CameraChunk, const TSet<FIntVector>& Candidates, TFunctionRef<uint64(const FIntVector& ChunkCoords)> GetConnections, TSet<FIntVector>& OutVisible);
+};
@@ -0,0 +1,149 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ChunkWarmCache.h"
+#include "ChunkHolder.h"
+#include "EnigmaVoxel/Core/Log/DefinedLog.h"
+#include "Misc/Compression.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+SIZE_T FCompressedChunk::GetAllocatedSize() const
+{
+	return sizeof(FCompressedChunk) + Payload.GetAllocatedSize();
+}
+
+void FChunkWarmCache::SetBudget(SIZE_T InBudgetBytes)
+{
+	BudgetBytes = InBudgetBytes;
+	EvictOverBudget();
+}
+
+bool FChunkWarmCache::Store(const FChunkHolder& Holder, double Now)
+{
+	if (BudgetBytes == 0)
+	{
+		return false;
+	}
+
+	TSharedPtr<FCompressedChunk> Entry = MakeShared<FCompressedChunk>();
+	if (!Compress(Holder, *Entry))
+	{
+		UE_LOG(LogEnigmaVoxelChunk, Warning, TEXT("Fail to compress chunk -> %s"), *Holder.Coords.ToString());
+		return false;
+	}
+	Entry->LastTouchedTime = Now;
+
+	if (TSharedPtr<FCompressedChunk>* Existing = Entries.Find(Holder.Coords))
+	{
+		UsedBytes -= FMath::Min(UsedBytes, (*Existing)->GetAllocatedSize());
+	}
+	UsedBytes += Entry->GetAllocatedSize();
+	Entries.Add(Holder.Coords, MoveTemp(Entry));
+
+	EvictOverBudget();
+	return Entries.Contains(Holder.Coords);
+}
+
+TSharedPtr<FCompressedChunk> FChunkWarmCache::Take(const FIntVector& Coords)
+{
+	TSharedPtr<FCompressedChunk> Entry;
+	if (Entries.RemoveAndCopyValue(Coords, Entry))
+	{
+		UsedBytes -= FMath::Min(UsedBytes, Entry->GetAllocatedSize());
+	}
+	return Entry;
+}
+
+void FChunkWarmCache::EvictOverBudget()
+{
+	if (UsedBytes <= BudgetBytes)
+	{
+		return;
+	}
+
+	TArray<TSharedPtr<FCompressedChunk>> Sorted;
+	Entries.GenerateValueArray(Sorted);
+	Sorted.Sort([](const TSharedPtr<FCompressedChunk>& A, const TSharedPtr<FCompressedChunk>& B)
+	{
+		return A->LastTouchedTime < B->LastTouchedTime;
+	});
+
+	for (const TSharedPtr<FCompressedChunk>& Entry : Sorted)
+	{
+		if (UsedBytes <= BudgetBytes)
+		{
+			break;
+		}
+		UsedBytes -= FMath::Min(UsedBytes, Entry->GetAllocatedSize());
+		Entries.Remove(Entry->Coords);
+	}
+}
+
+bool FChunkWarmCache::Compress(const FChunkHolder& Holder, FCompressedChunk& Out)
+{
+	Out.Coords = Holder.Coords;
+
+	TArray<uint8> Raw;
+	Raw.Reserve(Holder.IsUniform() ? 64 : FChunkLayout::Count * sizeof(uint16));
+	FMemoryWriter Writer(Raw);
+	Serialize(Writer, const_cast<FChunkHolder&>(Holder)); // Saving does not modify the holder
+
+	Out.UncompressedSize = Raw.Num();
+	int32 CompressedSize = FCompression::CompressMemoryBound(NAME_LZ4, Out.UncompressedSize);
+	Out.Payload.SetNumUninitialized(CompressedSize);
+	if (!FCompression::CompressMemory(NAME_LZ4, Out.Payload.GetData(), CompressedSize, Raw.GetData(), Raw.Num()))
+	{
+		return false;
+	}
+	Out.Payload.SetNum(CompressedSize, EAllowShrinking::Yes);
+	return true;
+}
+
+bool FChunkWarmCache::Decompress(const FCompressedChunk& In, FChunkHolder& Holder)
+{
+	TArray<uint8> Raw;
+	Raw.SetNumUninitialized(In.UncompressedSize);
+	if (!FCompression::UncompressMemory(NAME_LZ4, Raw.GetData(), Raw.Num(), In.Payload.GetData(), In.Payload.Num()))
+	{
+		return false;
+	}
+
+	FMemoryReader Reader(Raw);
+	Serialize(Reader, Holder);
+	if (Reader.IsError() || (!Holder.IsUniform() && Holder.Blocks.Num() != FChunkLayout::Count))
+	{
+		UE_LOG(LogEnigmaVoxelChunk, Warning, TEXT("Warm chunk -> %s does not match the chunk layout"), *In.Coords.ToString());
+		Holder.SetUniform(0);
+		return false;
+	}
+	if (!Holder.TryCompactUniform())
+	{
+		Holder.RebuildHeightMap();
+	}
+	return true;
+}
+
+/// Block storage of the holder: uniform flag, block IDs and the sparse extra data
+void FChunkWarmCache::Serialize(FArchive& Ar, FChunkHolder& Holder)
+{
+	bool bUniform = Holder.IsUniform();
+	Ar << bUniform;
+	if (bUniform)
+	{
+		uint16 UniformBlockID = Holder.UniformBlockID;
+		Ar << UniformBlockID;
+		if (Ar.IsLoading())
+		{
+			Holder.SetUniform(UniformBlockID);
+		}
+	}
+	else
+	{
+		if (Ar.IsLoading())
+		{
+			Holder.bUniform = false;
+		}
+		Holder.Blocks.BulkSerialize(Ar);
+	}
+	Ar << Holder.ExtraData;
+}
@@ -0,0 +1,57 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FChunkHolder;
+
+/**
+ * LZ4 compressed block data of an evicted chunk: the dense block IDs (or the single ID of
+ * an uniform chunk) followed by the sparse extra data. Runs of the same block ID compress
+ * very well so the payload is small.
+ */
+struct FCompressedChunk
+{
+	FIntVector    Coords = FIntVector::ZeroValue;
+	TArray<uint8> Payload; // Compressed FChunkWarmCache::Serialize output
+	int32         UncompressedSize = 0;
+	double        LastTouchedTime  = 0.0;
+
+	SIZE_T GetAllocatedSize() const;
+};
+
+/**
+ * Warm tier between "resident" and "gone". Evicted chunks are compressed in memory and
+ * keyed by chunk coordinates, a re-ticket takes the entry out and restores the blocks on
+ * the worker pool instead of running the generator. The cache is bounded in bytes and
+ * drops the least recently stored entries first.
+ *
+ * Only accessed from the game thread (under the UEnigmaWorld::ChunksLock write lock), decompression
+ * works on the entry that was taken out so it is safe on the workers.
+ */
+class FChunkWarmCache
+{
+public:
+	void SetBudget(SIZE_T InBudgetBytes);
+
+	/// Compress the holder blocks and store them, evict the oldest entries while over budget
+	bool Store(const FChunkHolder& Holder, double Now);
+	/// Take the entry out of the cache, nullptr when the chunk is not warm
+	TSharedPtr<FCompressedChunk> Take(const FIntVector& Coords);
+
+	SIZE_T GetUsedBytes() const { return UsedBytes; }
+	int32  Num() const { return Entries.Num(); }
+
+	static bool Compress(const FChunkHolder& Holder, FCompressedChunk& Out);
+	static bool Decompress(const FCompressedChunk& In, FChunkHolder& Holder);
+	/// Block IDs and extra data of the holder, loading replaces the holder blocks
+	static void Serialize(FArchive& Ar, FChunkHolder& Holder);
+
+private:
+	void EvictOverBudget();
+
+	TMap<FIntVector, TSharedPtr<FCompressedChunk>> Entries;
+	SIZE_T                                         UsedBytes   = 0;
+	SIZE_T                                         BudgetBytes = 64 * 1024 * 1024;
+};
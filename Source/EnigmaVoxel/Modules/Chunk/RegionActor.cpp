@@ -0,0 +1,24 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "RegionActor.h"
+#include "ChunkRegion.h"
+
+ARegionActor::ARegionActor()
+{
+	PrimaryActorTick.bCanEverTick = false;
+	if (DynamicMeshComponent)
+	{
+		DynamicMeshComponent->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+		DynamicMeshComponent->SetCollisionProfileName(UCollisionProfile::NoCollision_ProfileName);
+		DynamicMeshComponent->SetGenerateOverlapEvents(false);
+	}
+}
+
+void ARegionActor::UpdateRegionMesh(FRegionMesh& InRegion)
+{
+	DynamicMeshComponent->SetMesh(MoveTemp(InRegion.Mesh));
+	for (const TPair<UMaterialInterface*, int32>& P : InRegion.MaterialToSection)
+	{
+		DynamicMeshComponent->SetMaterial(P.Value, P.Key);
+	}
+}
@@ -0,0 +1,23 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Runtime/GeometryFramework/Public/DynamicMeshActor.h"
+#include "RegionActor.generated.h"
+
+struct FRegionMesh;
+
+/// Render proxy of a region cluster (FRegionMesh), distant chunks have no chunk actor and no
+/// collision, block queries still read the world data
+UCLASS()
+class ENIGMAVOXEL_API ARegionActor : public ADynamicMeshActor
+{
+	GENERATED_BODY()
+
+public:
+	ARegionActor();
+
+	/// Swap in a merged region mesh, the mesh is moved out of the region
+	void UpdateRegionMesh(FRegionMesh& InRegion);
+};
@@ -0,0 +1,126 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Misc/AutomationTest.h"
+#include "EnigmaVoxel/Modules/Block/Enum/BlockDirection.h"
+#include "EnigmaVoxel/Modules/Chunk/ChunkHolder.h"
+#include "EnigmaVoxel/Modules/Chunk/ChunkVisibility.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	constexpr uint16 SolidID = 1;
+
+	/// Block ID 0 is open, anything else is solid, no registered content needed
+	bool IsAir(uint16 BlockID)
+	{
+		return BlockID == 0;
+	}
+
+	/// Every pair of the listed faces is connected
+	uint64 MakeConnections(std::initializer_list<EBlockDirection> Faces)
+	{
+		uint64 Connections = FChunkVisibility::NoneConnected;
+		for (const EBlockDirection A : Faces)
+		{
+			for (const EBlockDirection B : Faces)
+			{
+				Connections |= 1ull << (static_cast<uint8>(A) * 6 + static_cast<uint8>(B));
+			}
+		}
+		return Connections;
+	}
+
+	/// Solid where Predicate(x, y, z) holds, air elsewhere
+	template <typename TPredicate>
+	void FillHolder(FChunkHolder& Holder, TPredicate Predicate)
+	{
+		Holder.Materialize();
+		for (int32 z = 0; z < FChunkLayout::SizeZ; ++z)
+		{
+			for (int32 y = 0; y < FChunkLayout::SizeY; ++y)
+			{
+				for (int32 x = 0; x < FChunkLayout::SizeX; ++x)
+				{
+					Holder.Blocks[FChunkLayout::Index(x, y, z)] = Predicate(x, y, z) ? SolidID : 0;
+				}
+			}
+		}
+	}
+
+	/// 5x5 chunks around the origin camera chunk, connections picked by the Chebyshev distance to it
+	int32 CountVisible(uint64 Camera, uint64 Ring, uint64 Outer)
+	{
+		TSet<FIntVector> Candidates;
+		for (int32 y = -2; y <= 2; ++y)
+		{
+			for (int32 x = -2; x <= 2; ++x)
+			{
+				Candidates.Add(FIntVector(x, y, 0));
+			}
+		}
+		TSet<FIntVector> Visible;
+		FChunkVisibility::GatherVisibleChunks(FIntVector::ZeroValue, Candidates, [Camera, Ring, Outer](const FIntVector& ChunkCoords)
+		{
+			const int32 Distance = FMath::Max(FMath::Abs(ChunkCoords.X), FMath::Abs(ChunkCoords.Y));
+			if (Distance == 0)
+			{
+				return Camera;
+			}
+			return Distance == 1 ? Ring : Outer;
+		}, Visible);
+		return Visible.Num();
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FChunkVisibilityConnectionsTest, "EnigmaVoxel.Chunk.Visibility.Connections",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FChunkVisibilityConnectionsTest::RunTest(const FString& Parameters)
+{
+	FChunkHolder Holder;
+
+	Holder.SetUniform(0);
+	TestEqual(TEXT("Uniform air connects every face"), FChunkVisibility::ComputeConnections(Holder, IsAir), FChunkVisibility::AllConnected);
+	Holder.SetUniform(SolidID);
+	TestEqual(TEXT("Uniform solid connects nothing"), FChunkVisibility::ComputeConnections(Holder, IsAir), FChunkVisibility::NoneConnected);
+
+	// Terrain up to half height, the air above touches the four sides and the top
+	FillHolder(Holder, [](int32 X, int32 Y, int32 Z) { return Z < FChunkLayout::SizeZ / 2; });
+	uint64 Connections = FChunkVisibility::ComputeConnections(Holder, IsAir);
+	TestTrue(TEXT("Half filled: north sees the sky"), FChunkVisibility::IsConnected(Connections, EBlockDirection::NORTH, EBlockDirection::UP));
+	TestTrue(TEXT("Half filled: west sees east"), FChunkVisibility::IsConnected(Connections, EBlockDirection::WEST, EBlockDirection::EAST));
+	TestFalse(TEXT("Half filled: the floor is sealed"), FChunkVisibility::IsConnected(Connections, EBlockDirection::NORTH, EBlockDirection::DOWN));
+
+	// Full height wall across X, the two halves only share the faces they both touch
+	FillHolder(Holder, [](int32 X, int32 Y, int32 Z) { return X == FChunkLayout::SizeX / 2; });
+	Connections = FChunkVisibility::ComputeConnections(Holder, IsAir);
+	TestFalse(TEXT("Wall: south does not see north"), FChunkVisibility::IsConnected(Connections, EBlockDirection::SOUTH, EBlockDirection::NORTH));
+	TestTrue(TEXT("Wall: south sees the sky"), FChunkVisibility::IsConnected(Connections, EBlockDirection::SOUTH, EBlockDirection::UP));
+	TestTrue(TEXT("Wall: north sees east"), FChunkVisibility::IsConnected(Connections, EBlockDirection::NORTH, EBlockDirection::EAST));
+
+	// Sealed tunnel along X at mid height under a solid roof
+	FillHolder(Holder, [](int32 X, int32 Y, int32 Z) { return Y != FChunkLayout::SizeY / 2 || Z != FChunkLayout::SizeZ / 2; });
+	Connections = FChunkVisibility::ComputeConnections(Holder, IsAir);
+	TestEqual(TEXT("Tunnel: only its two ends connect"), Connections, MakeConnections({EBlockDirection::SOUTH, EBlockDirection::NORTH}));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FChunkVisibilityWalkTest, "EnigmaVoxel.Chunk.Visibility.Walk",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FChunkVisibilityWalkTest::RunTest(const FString& Parameters)
+{
+	const uint64 All   = FChunkVisibility::AllConnected;
+	const uint64 None  = FChunkVisibility::NoneConnected;
+	const uint64 Caves = MakeConnections({EBlockDirection::NORTH, EBlockDirection::SOUTH, EBlockDirection::EAST, EBlockDirection::WEST});
+
+	TestEqual(TEXT("Open terrain: every chunk is visible"), CountVisible(All, All, All), 25);
+	// Underground, the sealed ring only lets the walk into its four side chunks
+	TestEqual(TEXT("Sealed ring around a cave: camera and side ring chunks"), CountVisible(Caves, None, Caves), 5);
+	// Columns filled to the top around the camera, the chunks behind them are seen over them
+	TestEqual(TEXT("Sealed ring under open sky: every chunk is visible"), CountVisible(Caves, None, All), 25);
+	return true;
+}
+
+#endif
@@ -0,0 +1,47 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "HorizonActor.h"
+#include "Components/DynamicMeshComponent.h"
+
+AHorizonActor::AHorizonActor()
+{
+	PrimaryActorTick.bCanEverTick = false;
+	RootComponent                 = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
+}
+
+void AHorizonActor::SetTile(const FIntVector& TileCoords, const FVector& RelativeLocation, UE::Geometry::FDynamicMesh3&& Mesh, UMaterialInterface* Material)
+{
+	UDynamicMeshComponent* Component = TileComponents.FindRef(TileCoords);
+	if (!Component && FreeComponents.Num() > 0)
+	{
+		Component = FreeComponents.Pop(EAllowShrinking::No);
+	}
+	if (!Component)
+	{
+		Component = NewObject<UDynamicMeshComponent>(this);
+		Component->SetupAttachment(RootComponent);
+		Component->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+		Component->SetCollisionProfileName(UCollisionProfile::NoCollision_ProfileName);
+		Component->SetGenerateOverlapEvents(false);
+		Component->SetCastShadow(false);
+		Component->RegisterComponent();
+	}
+	TileComponents.Add(TileCoords, Component);
+
+	Component->SetRelativeLocation(RelativeLocation);
+	Component->SetMesh(MoveTemp(Mesh));
+	Component->SetMaterial(0, Material);
+	Component->SetVisibility(true);
+}
+
+void AHorizonActor::RemoveTile(const FIntVector& TileCoords)
+{
+	TObjectPtr<UDynamicMeshComponent> Component;
+	if (!TileComponents.RemoveAndCopyValue(TileCoords, Component) || !Component)
+	{
+		return;
+	}
+	Component->SetVisibility(false);
+	Component->GetDynamicMesh()->Reset();
+	FreeComponents.Add(Component);
+}
@@ -0,0 +1,36 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "HorizonActor.generated.h"
+
+class UDynamicMeshComponent;
+namespace UE::Geometry
+{
+	class FDynamicMesh3;
+}
+
+/// Single actor holding every far horizon tile (FHorizonTile) as a mesh component, the
+/// actor sits on the absolute world origin and the components on their tile origin
+UCLASS()
+class ENIGMAVOXEL_API AHorizonActor : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	AHorizonActor();
+
+	/// Show a built tile, reuse a released component when there is one
+	/// @param RelativeLocation Tile origin in absolute world space
+	void SetTile(const FIntVector& TileCoords, const FVector& RelativeLocation, UE::Geometry::FDynamicMesh3&& Mesh, UMaterialInterface* Material);
+	void RemoveTile(const FIntVector& TileCoords);
+
+protected:
+	UPROPERTY()
+	TMap<FIntVector, TObjectPtr<UDynamicMeshComponent>> TileComponents;
+	/// Hidden components kept for the next tile, the ring moves with the player
+	UPROPERTY()
+	TArray<TObjectPtr<UDynamicMeshComponent>> FreeComponents;
+};
@@ -0,0 +1,45 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "HorizonTile.h"
+#include "EnigmaVoxel/Core/World/VoxelCoords.h"
+#include "EnigmaVoxel/Core/World/Gen/WorldGen.hpp"
+
+void FHorizonTile::Build(FHorizonTile& Tile, int32 TileChunks, int32 CellBlocks, float BlockSize)
+{
+	const int32        TileBlocks = TileChunks * ChunkBlockXCount;
+	const int32        Cells      = FMath::Max(1, TileBlocks / CellBlocks);
+	const FInt64Vector Origin     = FVoxelCoords::ChunkToBlock64(FIntVector(Tile.Coords.X * TileChunks, Tile.Coords.Y * TileChunks, 0));
+
+	// Samples are shared with the neighbour tiles on the edges, tiles join without seams
+	UE::Geometry::FDynamicMesh3 Mesh;
+	TArray<int32>               Vertices;
+	Vertices.SetNumUninitialized((Cells + 1) * (Cells + 1));
+	for (int32 y = 0; y <= Cells; ++y)
+	{
+		for (int32 x = 0; x <= Cells; ++x)
+		{
+			const int64 BlockX = Origin.X + x * CellBlocks;
+			const int64 BlockY = Origin.Y + y * CellBlocks;
+			const int32 Height = FWorldGen::SampleHeight(BlockX, BlockY) - 1;
+
+			Vertices[x + y * (Cells + 1)] = Mesh.AppendVertex(FVector3d(x * CellBlocks * BlockSize, y * CellBlocks * BlockSize, Height * BlockSize));
+		}
+	}
+
+	// Same winding as the block UP face
+	for (int32 y = 0; y < Cells; ++y)
+	{
+		for (int32 x = 0; x < Cells; ++x)
+		{
+			const int32 V00 = Vertices[x + y * (Cells + 1)];
+			const int32 V10 = Vertices[x + 1 + y * (Cells + 1)];
+			const int32 V01 = Vertices[x + (y + 1) * (Cells + 1)];
+			const int32 V11 = Vertices[x + 1 + (y + 1) * (Cells + 1)];
+			Mesh.AppendTriangle(V11, V10, V00, 0);
+			Mesh.AppendTriangle(V11, V00, V01, 0);
+		}
+	}
+
+	Tile.Mesh = MoveTemp(Mesh);
+	Tile.bReady.store(true, std::memory_order_release);
+}
@@ -0,0 +1,27 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DynamicMesh/DynamicMesh3.h"
+
+/**
+ * Far terrain tile drawn past the chunk view radius. A tile covers a square of chunks and is
+ * built from the generator heightmap only (FWorldGen::SampleHeight), one vertex every few
+ * blocks, so it has no voxel storage, no collision and no chunk actor.
+ *
+ * The surface is sunk one block under the real terrain, loaded chunks overlapping the tile
+ * always draw over it.
+ */
+struct FHorizonTile
+{
+	FIntVector                  Coords = FIntVector::ZeroValue; // In tiles
+	UE::Geometry::FDynamicMesh3 Mesh;
+	std::atomic<bool>           bReady{false}; // Mesh built, set by the worker
+	bool                        bUploaded = false;
+
+	/// Worker side, sample the heightmap and triangulate the tile surface in tile local space
+	/// @param TileChunks Edge of the tile in chunks
+	/// @param CellBlocks Blocks between two samples, divides the tile edge
+	static void Build(FHorizonTile& Tile, int32 TileChunks, int32 CellBlocks, float BlockSize);
+};
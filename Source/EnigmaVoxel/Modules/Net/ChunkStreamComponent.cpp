@@ -0,0 +1,139 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ChunkStreamComponent.h"
+#include "EnigmaVoxel/Core/Log/DefinedLog.h"
+#include "EnigmaVoxel/Core/World/EnigmaWorld.h"
+#include "EnigmaVoxel/Core/World/EnigmaWorldSubsystem.h"
+#include "Engine/GameInstance.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerController.h"
+
+UChunkStreamComponent::UChunkStreamComponent()
+{
+	PrimaryComponentTick.bCanEverTick = false;
+	SetIsReplicatedByDefault(true);
+}
+
+void UChunkStreamComponent::BeginPlay()
+{
+	Super::BeginPlay();
+	if (UEnigmaWorld* World = FindEnigmaWorld())
+	{
+		World->RegisterChunkStream(this);
+	}
+}
+
+void UChunkStreamComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UEnigmaWorld* World = FindEnigmaWorld())
+	{
+		World->UnregisterChunkStream(this);
+	}
+	Super::EndPlay(EndPlayReason);
+}
+
+UEnigmaWorld* UChunkStreamComponent::FindEnigmaWorld() const
+{
+	const UGameInstance*         GameInstance = GetWorld() ? GetWorld()->GetGameInstance() : nullptr;
+	const UEnigmaWorldSubsystem* Subsystem    = GameInstance ? GameInstance->GetSubsystem<UEnigmaWorldSubsystem>() : nullptr;
+	return Subsystem ? Subsystem->LoadedWorlds.FindRef(WorldID) : nullptr;
+}
+
+bool UChunkStreamComponent::IsStreamedToRemoteClient() const
+{
+	const APlayerController* PC = Cast<APlayerController>(GetOwner());
+	return PC && GetOwnerRole() == ROLE_Authority && !PC->IsLocalController();
+}
+
+void UChunkStreamComponent::StreamChunks(UEnigmaWorld& World, const TMap<FIntVector, TArray<uint8>>& ChangePackets, double Now)
+{
+	const APlayerController* PC   = Cast<APlayerController>(GetOwner());
+	const APawn*             Pawn = PC ? PC->GetPawn() : nullptr;
+	if (!Pawn || !IsStreamedToRemoteClient())
+	{
+		return;
+	}
+
+	// Token bucket, at most one second of bytes saved up while idle
+	const double Elapsed = LastStreamTime > 0.0 ? Now - LastStreamTime : 0.0;
+	LastStreamTime       = Now;
+	Budget               = FMath::Min(Budget + Elapsed * BytesPerSecond, static_cast<double>(BytesPerSecond));
+
+	const FIntVector Center = UEnigmaWorld::WorldPosToChunkCoords(World.ToAbsoluteWorldPos(Pawn->GetActorLocation()));
+	const int32      Radius = StreamRadius >= 0 ? StreamRadius : World.GetTicketRadius();
+
+	// One chunk of hysteresis, a pawn walking along a chunk border does not resend it every crossing
+	for (auto It = SentChunks.CreateIterator(); It; ++It)
+	{
+		const FIntVector Delta = *It - Center;
+		if (FMath::Max(FMath::Abs(Delta.X), FMath::Abs(Delta.Y)) > Radius + 1)
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	// The client must see every change of the chunks it holds, changes are never held back by the budget
+	for (const TPair<FIntVector, TArray<uint8>>& Change : ChangePackets)
+	{
+		if (SentChunks.Contains(Change.Key))
+		{
+			SendPacket(Change.Value);
+		}
+	}
+
+	// Nearest ring first, the chunks under the pawn arrive before the horizon
+	for (int32 Ring = 0; Ring <= Radius && Budget > 0.0; ++Ring)
+	{
+		for (int32 dy = -Ring; dy <= Ring && Budget > 0.0; ++dy)
+		{
+			for (int32 dx = -Ring; dx <= Ring && Budget > 0.0; ++dx)
+			{
+				if (FMath::Max(FMath::Abs(dx), FMath::Abs(dy)) != Ring)
+				{
+					continue;
+				}
+				const FIntVector ChunkCoords = Center + FIntVector(dx, dy, 0);
+				TArray<uint8>    Packet;
+				if (SentChunks.Contains(ChunkCoords) || !World.EncodeChunkPacket(ChunkCoords, Packet))
+				{
+					continue; // Sent already, or not generated yet on the server
+				}
+				SentChunks.Add(ChunkCoords);
+				++SentChunkCount;
+				SendPacket(Packet);
+			}
+		}
+	}
+}
+
+void UChunkStreamComponent::SendPacket(const TArray<uint8>& Packet)
+{
+	Budget    -= Packet.Num();
+	SentBytes += Packet.Num();
+	ClientReceiveChunkPacket(Packet);
+}
+
+void UChunkStreamComponent::ReportDroppedChunks(const TArray<FIntVector>& ChunkCoords)
+{
+	if (!ChunkCoords.IsEmpty())
+	{
+		ServerForgetChunks(ChunkCoords);
+	}
+}
+
+void UChunkStreamComponent::ClientReceiveChunkPacket_Implementation(const TArray<uint8>& Packet)
+{
+	if (UEnigmaWorld* World = FindEnigmaWorld())
+	{
+		World->ReceiveChunkPacket(Packet);
+	}
+}
+
+void UChunkStreamComponent::ServerForgetChunks_Implementation(const TArray<FIntVector>& ChunkCoords)
+{
+	for (const FIntVector& Coords : ChunkCoords)
+	{
+		SentChunks.Remove(Coords);
+	}
+	UE_LOG(LogEnigmaVoxelNet, Verbose, TEXT("%s dropped %d chunks, they are sent again once in range"), *GetNameSafe(GetOwner()), ChunkCoords.Num());
+}
@@ -0,0 +1,68 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "ChunkStreamComponent.generated.h"
+
+class UEnigmaWorld;
+
+/**
+ * Streams the chunks of the server UEnigmaWorld to the client owning the player controller.
+ * The server sends the resident chunks around the player pawn as FChunkPacket, nearest ring
+ * first, within a byte budget refilled every second, and the change record of every chunk the
+ * client holds that was edited this tick. Both go through the same reliable client RPC so a
+ * record never overtakes the full packet of its chunk.
+ *
+ * The client world does not generate the chunks, it waits for their packets. A chunk the client
+ * drops is reported back so the server sends it again once it is in range.
+ *
+ * Driven by UEnigmaWorld::UpdateChunkStreams from the world tick, the local player of a listen
+ * server renders the server world itself and is not streamed.
+ */
+UCLASS(ClassGroup=(Enigma), meta=(BlueprintSpawnableComponent))
+class ENIGMAVOXEL_API UChunkStreamComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UChunkStreamComponent();
+
+	/// Server: send the change packets of this tick (keyed by chunk), then new chunks until the budget is spent
+	void StreamChunks(UEnigmaWorld& World, const TMap<FIntVector, TArray<uint8>>& ChangePackets, double Now);
+	/// Client: report the chunks the client world dropped since the last call
+	void ReportDroppedChunks(const TArray<FIntVector>& ChunkCoords);
+
+	bool IsStreamedToRemoteClient() const;
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="Chunk Stream")
+	int32 WorldID = 0; // UEnigmaWorldSubsystem::LoadedWorlds key
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="Chunk Stream")
+	int32 BytesPerSecond = 64 * 1024; // Packet bytes sent per second to this client, full chunks wait once spent. Keep under the net driver client rate
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="Chunk Stream")
+	int32 StreamRadius = INDEX_NONE; // Chunks around the pawn, INDEX_NONE follows the world ticket radius
+
+	/// Stats
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere, Category="Chunk Stream")
+	int64 SentBytes = 0;
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere, Category="Chunk Stream")
+	int32 SentChunkCount = 0;
+
+protected:
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	UFUNCTION(Client, Reliable)
+	void ClientReceiveChunkPacket(const TArray<uint8>& Packet);
+	UFUNCTION(Server, Reliable)
+	void ServerForgetChunks(const TArray<FIntVector>& ChunkCoords);
+
+private:
+	UEnigmaWorld* FindEnigmaWorld() const;
+	void          SendPacket(const TArray<uint8>& Packet);
+
+	TSet<FIntVector> SentChunks; // Server, chunks the client holds or is receiving
+	double           Budget         = 0.0; // Server, bytes that can still be sent
+	double           LastStreamTime = 0.0;
+};